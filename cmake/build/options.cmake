@@ -79,7 +79,13 @@ set(SETTING_PATH_MEMORY_INFO "/proc/meminfo"
   CACHE STRING "Path to file containing memory info")
 set(SETTING_PATH_MESSAGING_FIFO "/tmp/polybar_mqueue.%pid%"
   CACHE STRING "Path to file containing the current temperature")
+set(SETTING_PATH_MESSAGING_SOCKET "/tmp/polybar_ipc.%pid%.sock"
+  CACHE STRING "Path to unix socket used for inter-process messaging")
+set(SETTING_PATH_STATS_DUMP "/tmp/polybar_stats.%pid%.json"
+  CACHE STRING "Path to file where performance counters are dumped")
 set(SETTING_PATH_TEMPERATURE_INFO "/sys/class/thermal/thermal_zone%zone%/temp"
   CACHE STRING "Path to file containing the current temperature")
+set(SETTING_PATH_TRACE_DUMP "/tmp/polybar_trace.%pid%.json"
+  CACHE STRING "Path to file where recorded trace events are dumped")
 
 # }}}
@@ -85,6 +85,7 @@ namespace mpd {
     int get_fd();
     void idle();
     int noidle();
+    bool wait(int timeout_ms, int interrupt_fd = -1);
 
     unique_ptr<mpdstatus> get_status();
     unique_ptr<mpdstatus> get_status_safe();
@@ -131,7 +132,7 @@ namespace mpd {
 
     void fetch_data(mpdconnection* conn);
     void update(int event, mpdconnection* connection);
-    void update_timer();
+    bool update_timer();
 
     bool random() const;
     bool repeat() const;
@@ -143,6 +144,7 @@ namespace mpd {
     int get_queuelen() const;
     unsigned get_total_time() const;
     unsigned get_elapsed_time() const;
+    unsigned long get_elapsed_ms() const;
     unsigned get_elapsed_percentage();
     string get_formatted_elapsed();
     string get_formatted_total();
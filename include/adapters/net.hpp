@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <mutex>
 #include <arpa/inet.h>
 #include <ifaddrs.h>
 #include <iwlib.h>
@@ -11,6 +13,7 @@
 
 #include "common.hpp"
 #include "config.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -20,6 +23,7 @@ namespace net {
   DEFINE_ERROR(network_error);
 
   bool is_wireless_interface(string ifname);
+  bool is_interface_pattern(const string& ifname);
 
   // types {{{
 
@@ -34,20 +38,80 @@ namespace net {
     }
   };
 
-  using bytes_t = unsigned int;
+  using bytes_t = uint64_t;
 
-  struct link_activity {
-    bytes_t transmitted{0};
+  struct link_counters {
     bytes_t received{0};
-    chrono::system_clock::time_point time;
+    bytes_t transmitted{0};
+  };
+
+  struct link_activity {
+    vector<pair<string, link_counters>> interfaces;
+    chrono::steady_clock::time_point time;
   };
 
   struct link_status {
-    string ip;
     link_activity previous{};
     link_activity current{};
   };
 
+  // }}}
+  // class : sampler {{{
+
+  /**
+   * Process wide reader of the transfer counters of all
+   * interfaces, shared by all network modules so that
+   * /proc/net/dev is only read once per tick
+   */
+  class sampler {
+   public:
+    explicit sampler();
+
+    bool read(const string& pattern, link_activity& activity);
+    vector<string> interfaces(const string& pattern);
+
+   protected:
+    void refresh();
+
+   private:
+    std::mutex m_mutex;
+    file_util::pread_reader m_file;
+    chrono::steady_clock::time_point m_sampled;
+    bool m_valid{false};
+    vector<pair<string, link_counters>> m_interfaces;
+  };
+
+  shared_ptr<sampler> get_sampler();
+
+  // }}}
+  // class : link_monitor {{{
+
+  /**
+   * Tracks the ipv4 address of the interfaces accepted by the
+   * filter and gets notified of their link and address changes
+   * through a NETLINK_ROUTE socket
+   */
+  class link_monitor {
+   public:
+    using filter_t = function<bool(unsigned int ifindex, const char* ifname)>;
+
+    explicit link_monitor(filter_t&& filter);
+    ~link_monitor();
+
+    bool wait(int timeout_ms);
+    string ip();
+
+   protected:
+    void request_addresses();
+    bool process();
+
+   private:
+    int m_fd{-1};
+    filter_t m_filter;
+    std::mutex m_mutex;
+    string m_ip;
+  };
+
   // }}}
   // class : network {{{
 
@@ -59,6 +123,7 @@ namespace net {
     virtual bool query(bool accumulate = false);
     virtual bool connected() const = 0;
     virtual bool ping() const;
+    bool wait_for_change(int timeout_ms);
 
     string ip() const;
     string downspeed(int minwidth = 3) const;
@@ -67,11 +132,17 @@ namespace net {
    protected:
     void check_tuntap();
     bool test_interface() const;
+    bool ping_command() const;
     string format_speedrate(float bytes_diff, int minwidth) const;
+    link_counters transferred() const;
 
     int m_socketfd{0};
+    shared_ptr<sampler> m_sampler;
+    unique_ptr<link_monitor> m_monitor;
+    mutable unique_ptr<file_util::pread_reader> m_operstate;
     link_status m_status{};
     string m_interface;
+    bool m_aggregate{false};
     bool m_tuntap{false};
   };
 
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <boost/any.hpp>
 #include <boost/optional.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/property_tree/ini_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
 
 #include "common.hpp"
 #include "components/logger.hpp"
@@ -16,27 +18,64 @@ POLYBAR_NS
 #define GET_CONFIG_VALUE(section, var, name) var = m_conf.get<decltype(var)>(section, name, var)
 #define REQ_CONFIG_VALUE(section, var, name) var = m_conf.get<decltype(var)>(section, name)
 
-using ptree = boost::property_tree::ptree;
-
 DEFINE_ERROR(value_error);
 DEFINE_ERROR(key_error);
 
+/**
+ * Parameter value as read from the config file, with
+ * local ${section.key} references resolved at load time
+ */
+struct config_value {
+  string raw;
+  string resolved;
+  string error;
+
+  /**
+   * Converted values keyed by type, filled on first lookup
+   */
+  mutable std::unordered_map<std::type_index, boost::any> cache;
+};
+
+/**
+ * Parameters of a single section, keys ending with -N
+ * are also indexed as lists under their base name
+ */
+struct config_section {
+  std::unordered_map<string, config_value> values;
+  std::unordered_map<string, vector<const config_value*>> lists;
+};
+
+/**
+ * Contents of a loaded config file, never modified once
+ * loaded so that readers can keep using their snapshot
+ * while the config is being reloaded
+ */
+struct config_table {
+  string file;
+  string bar;
+  std::unordered_map<string, config_section> sections;
+  vector<string> section_order;
+};
+
 class config {
  public:
   explicit config(const logger& logger, const xresource_manager& xrm) : m_logger(logger), m_xrm(xrm) {}
 
   void load(string file, string barname);
+  void reload();
   string filepath() const;
   string bar_section() const;
   vector<string> defined_bars() const;
   string build_path(const string& section, const string& key) const;
   void warn_deprecated(string section, string key, string replacement) const;
+  vector<string> changed_keys(const string& section) const;
+  bool changed(const string& section) const;
 
   /**
    * Get parameter for the current bar by name
    */
   template <typename T>
-  T get(string key) const {
+  T get(const string& key) const {
     return get<T>(bar_section(), key);
   }
 
@@ -44,15 +83,19 @@ class config {
    * Get value of a variable by section and parameter name
    */
   template <typename T>
-  T get(string section, string key) const {
-    auto val = m_ptree.get_optional<T>(build_path(section, key));
+  T get(const string& section, const string& key) const {
+    auto table = snapshot();
+    auto value = find(*table, section, key);
 
-    if (val == boost::none)
+    if (value == nullptr)
       throw key_error("Missing parameter [" + section + "." + key + "]");
 
-    auto str_val = m_ptree.get<string>(build_path(section, key));
+    auto result = convert<T>(section, key, *value);
 
-    return dereference<T>(section, key, str_val, val.get());
+    if (result == boost::none)
+      throw key_error("Missing parameter [" + section + "." + key + "]");
+
+    return result.get();
   }
 
   /**
@@ -60,18 +103,21 @@ class config {
    * with a default value in case the parameter isn't defined
    */
   template <typename T>
-  T get(string section, string key, T default_value) const {
-    auto val = m_ptree.get_optional<T>(build_path(section, key));
-    auto str_val = m_ptree.get_optional<string>(build_path(section, key));
+  T get(const string& section, const string& key, T default_value) const {
+    auto table = snapshot();
+    auto value = find(*table, section, key);
 
-    return dereference<T>(section, key, str_val.get_value_or(""), val.get_value_or(default_value));
+    if (value == nullptr)
+      return default_value;
+
+    return convert<T>(section, key, *value).get_value_or(default_value);
   }
 
   /**
    * Get list of values for the current bar by name
    */
   template <typename T>
-  vector<T> get_list(string key) const {
+  vector<T> get_list(const string& key) const {
     return get_list<T>(bar_section(), key);
   }
 
@@ -79,14 +125,8 @@ class config {
    * Get list of values by section and parameter name
    */
   template <typename T>
-  vector<T> get_list(string section, string key) const {
-    vector<T> vec;
-    boost::optional<T> value;
-
-    while ((value = m_ptree.get_optional<T>(build_path(section, key) + "-" + to_string(vec.size()))) != boost::none) {
-      auto str_val = m_ptree.get<string>(build_path(section, key) + "-" + to_string(vec.size()));
-      vec.emplace_back(dereference<T>(section, key, str_val, value.get()));
-    }
+  vector<T> get_list(const string& section, const string& key) const {
+    auto vec = collect<T>(section, key);
 
     if (vec.empty())
       throw key_error("Missing parameter [" + section + "." + key + "-0]");
@@ -99,14 +139,8 @@ class config {
    * with a default list in case the list isn't defined
    */
   template <typename T>
-  vector<T> get_list(string section, string key, vector<T> default_value) const {
-    vector<T> vec;
-    boost::optional<T> value;
-
-    while ((value = m_ptree.get_optional<T>(build_path(section, key) + "-" + to_string(vec.size()))) != boost::none) {
-      auto str_val = m_ptree.get<string>(build_path(section, key) + "-" + to_string(vec.size()));
-      vec.emplace_back(dereference<T>(section, key, str_val, value.get()));
-    }
+  vector<T> get_list(const string& section, const string& key, vector<T> default_value) const {
+    auto vec = collect<T>(section, key);
 
     if (vec.empty())
       return default_value;
@@ -115,102 +149,72 @@ class config {
   }
 
  protected:
+  shared_ptr<const config_table> snapshot() const;
+  const config_value* find(const config_table& table, const string& section, const string& key) const;
+  const vector<const config_value*>* find_list(
+      const config_table& table, const string& section, const string& key) const;
+
   /**
-   * Dereference value reference
+   * Collect the list values up to the first one
+   * that can't be converted to the requested type
    */
   template <typename T>
-  T dereference(string section, string key, string var, const T value) const {
-    if (var.substr(0, 2) != "${" || var.substr(var.length() - 1) != "}") {
-      return value;
+  vector<T> collect(const string& section, const string& key) const {
+    vector<T> vec;
+    auto table = snapshot();
+    auto list = find_list(*table, section, key);
+
+    if (list != nullptr) {
+      vec.reserve(list->size());
+
+      for (auto&& value : *list) {
+        auto result = convert<T>(section, key, *value);
+        if (result == boost::none)
+          break;
+        vec.emplace_back(result.get());
+      }
     }
 
-    auto path = var.substr(2, var.length() - 3);
-    size_t pos;
-
-    if (path.find("env:") == 0) {
-      return dereference_env<T>(path.substr(4), value);
-    } else if (path.find("xrdb:") == 0) {
-      return dereference_xrdb<T>(path.substr(5), value);
-    } else if ((pos = path.find(".")) != string::npos) {
-      return dereference_local<T>(path.substr(0, pos), path.substr(pos + 1), section);
-    } else {
-      throw value_error("Invalid reference defined at [" + build_path(section, key) + "]");
-    }
+    return vec;
   }
 
   /**
-   * Dereference local value reference defined using:
-   *  ${root.key}
-   *  ${self.key}
-   *  ${section.key}
+   * Convert value to the requested type, the result
+   * is cached so that the conversion only happens once
    */
   template <typename T>
-  T dereference_local(string section, string key, string current_section) const {
-    if (section == "BAR")
-      m_logger.warn("${BAR.key} is deprecated. Use ${root.key} instead");
+  boost::optional<T> convert(const string& section, const string& key, const config_value& value) const {
+    if (!value.error.empty())
+      throw value_error(string{value.error});
 
-    section = string_util::replace(section, "BAR", bar_section(), 0, 3);
-    section = string_util::replace(section, "root", bar_section(), 0, 4);
-    section = string_util::replace(section, "self", current_section, 0, 4);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto cached = value.cache.find(typeid(T));
 
-    auto path = build_path(section, key);
-    auto result = m_ptree.get_optional<T>(path);
+    if (cached != value.cache.end())
+      return boost::any_cast<const boost::optional<T>&>(cached->second);
 
-    if (result == boost::none)
-      throw value_error("Unexisting reference defined [" + path + "]");
+    typename boost::property_tree::translator_between<string, T>::type translator;
+    auto result = translator.get_value(dereference(section, key, value.resolved));
+    value.cache.emplace(typeid(T), result);
 
-    return dereference<T>(section, key, m_ptree.get<string>(path), result.get());
+    return result;
   }
 
-  /**
-   * Dereference environment variable reference defined using:
-   *  ${env:key}
-   *  ${env:key:fallback value}
-   */
-  template <typename T>
-  T dereference_env(string var, T fallback) const {
-    size_t pos;
-
-    if ((pos = var.find(":")) != string::npos) {
-      fallback = boost::lexical_cast<T>(var.substr(pos + 1));
-      var.erase(pos);
-    }
-
-    if (env_util::has(var.c_str()))
-      return boost::lexical_cast<T>(env_util::get(var.c_str()));
-
-    return fallback;
-  }
-
-  /**
-   * Dereference X resource db value defined using:
-   *  ${xrdb:key}
-   *  ${xrdb:key:fallback value}
-   */
-  template <typename T>
-  T dereference_xrdb(string var, T fallback) const {
-    size_t pos;
-
-    if ((pos = var.find(":")) != string::npos) {
-      fallback = boost::lexical_cast<T>(var.substr(pos + 1));
-      var.erase(pos);
-    }
-
-    if (std::is_same<string, T>::value)
-      return boost::lexical_cast<T>(m_xrm.get_string(var, boost::lexical_cast<string>(fallback)));
-    else if (std::is_same<float, T>::value)
-      return boost::lexical_cast<T>(m_xrm.get_float(var, boost::lexical_cast<float>(fallback)));
-    else if (std::is_same<int, T>::value)
-      return boost::lexical_cast<T>(m_xrm.get_int(var, boost::lexical_cast<int>(fallback)));
-    return fallback;
-  }
+  string dereference(const string& section, const string& key, const string& var) const;
+  string dereference_local(const config_table& table, string section, const string& key,
+      const string& current_section, size_t depth) const;
+  string dereference_env(string var, const string& raw) const;
+  string dereference_xrdb(string var) const;
+  string resolve(const config_table& table, const string& section, const string& key, const string& var,
+      size_t depth = 0) const;
 
  private:
   const logger& m_logger;
   const xresource_manager& m_xrm;
-  ptree m_ptree;
-  string m_file;
-  string m_current_bar;
+  shared_ptr<const config_table> m_table{make_shared<config_table>()};
+  shared_ptr<const config_table> m_previous{make_shared<config_table>()};
+  mutable std::mutex m_tablelock;
+  mutable std::mutex m_mutex;
 };
 
 namespace {
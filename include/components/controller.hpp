@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iosfwd>
+
 #include "common.hpp"
 #include "components/config.hpp"
 #include "components/eventloop.hpp"
@@ -23,7 +25,7 @@ using watch_t = inotify_util::watch_t;
 
 class controller {
  public:
-  explicit controller(connection& conn, const logger& logger, const config& config, unique_ptr<eventloop> eventloop,
+  explicit controller(connection& conn, const logger& logger, config& config, unique_ptr<eventloop> eventloop,
       unique_ptr<bar> bar, inotify_util::watch_t& confwatch)
       : m_connection(conn)
       , m_log(logger)
@@ -48,17 +50,26 @@ class controller {
   void wait_for_xevent();
 
   void bootstrap_modules();
+  vector<string> module_names(alignment align) const;
+  module_t make_module(const string& module_name) const;
+
+  void dump_trace(string path = "");
+  void dump_stats(string path = "");
+  void write_stats(std::ostream& out);
 
   void on_ipc_action(const ipc_action& message);
+  void on_ipc_command(const ipc_command& message);
+  string on_ipc_query(const ipc_query& message);
   void on_mouse_event(string input);
   void on_unrecognized_action(string input);
   void on_update();
+  void on_reload();
 
  private:
   connection& m_connection;
   registry m_registry{m_connection};
   const logger& m_log;
-  const config& m_conf;
+  config& m_conf;
   unique_ptr<eventloop> m_eventloop;
   unique_ptr<bar> m_bar;
   unique_ptr<ipc> m_ipc;
@@ -73,6 +84,12 @@ class controller {
 
   vector<thread> m_threads;
 
+  /**
+   * Guards the eventloop's module list, which is modified by
+   * config reloads while the ipc thread answers queries about it
+   */
+  std::mutex m_modulelock;
+
   inotify_util::watch_t& m_confwatch;
   command_util::command_t m_command;
 
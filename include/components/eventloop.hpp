@@ -12,7 +12,7 @@ POLYBAR_NS
 using module_t = unique_ptr<modules::module_interface>;
 using modulemap_t = map<alignment, vector<module_t>>;
 
-enum class event_type { NONE = 0, UPDATE, CHECK, INPUT, QUIT };
+enum class event_type { NONE = 0, UPDATE, CHECK, INPUT, RELOAD, QUIT };
 struct event {
   int type;
   char data[256]{'\0'};
@@ -36,6 +36,7 @@ class eventloop {
 
   void set_update_cb(callback<>&& cb);
   void set_input_db(callback<string>&& cb);
+  void set_reload_cb(callback<>&& cb);
 
   void add_module(const alignment pos, module_t&& module);
 
@@ -51,6 +52,7 @@ class eventloop {
   void on_update();
   void on_input(string input);
   void on_check();
+  void on_reload();
   void on_quit();
 
  private:
@@ -62,6 +64,7 @@ class eventloop {
 
   callback<> m_update_cb;
   callback<string> m_unrecognized_input_cb;
+  callback<> m_reload_cb;
 };
 
 namespace {
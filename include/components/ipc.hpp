@@ -22,6 +22,14 @@ struct ipc_action {
   static constexpr const char* prefix{"action:"};
   string payload;
 };
+struct ipc_set {
+  static constexpr const char* prefix{"set:"};
+  string payload;
+};
+struct ipc_query {
+  static constexpr const char* prefix{"query:"};
+  string payload;
+};
 
 /**
  * Component used for inter-process communication.
@@ -29,22 +37,55 @@ struct ipc_action {
  * A unique messaging channel will be setup for each
  * running process which will allow messages and
  * events to be sent to the process externally.
+ *
+ * Messages are newline terminated and can either be written
+ * to the fifo or sent over the unix socket. Socket clients
+ * may keep the connection open and send any number of messages,
+ * each of them is answered with a single line reply:
+ *  ok [data]
+ *  error <reason>
  */
 class ipc {
  public:
-  explicit ipc(const logger& logger) : m_log(logger) {}
+  using set_callback = function<bool(const ipc_set&)>;
+  using query_callback = function<string(const ipc_query&)>;
+
+  explicit ipc(const logger& logger);
   ~ipc();
 
   void attach_callback(callback<const ipc_command&>&& cb);
   void attach_callback(callback<const ipc_hook&>&& cb);
   void attach_callback(callback<const ipc_action&>&& cb);
-  void receive_messages();
+  void attach_callback(set_callback&& cb);
+  void attach_callback(query_callback&& cb);
+  void start();
 
  protected:
-  void parse(const string& payload) const;
-  void delegate(const ipc_command& msg) const;
-  void delegate(const ipc_hook& msg) const;
-  void delegate(const ipc_action& msg) const;
+  /**
+   * Pending input and unsent replies of a connected client
+   */
+  struct client {
+    string input;
+    string output;
+    uint32_t events{0};
+    bool closing{false};
+  };
+
+  void receive_messages();
+  void listen();
+  void accept_clients();
+  void handle_client(int fd, uint32_t events);
+  bool receive(int fd, string& buffer, string* replies);
+  bool flush(int fd, client& conn);
+  void disconnect(int fd);
+  void cleanup();
+
+  string parse(const string& payload) const;
+  bool delegate(const ipc_command& msg) const;
+  bool delegate(const ipc_hook& msg) const;
+  bool delegate(const ipc_action& msg) const;
+  bool delegate(const ipc_set& msg) const;
+  string delegate(const ipc_query& msg) const;
 
  private:
   const logger& m_log;
@@ -52,11 +93,25 @@ class ipc {
   vector<callback<const ipc_command&>> m_command_callbacks;
   vector<callback<const ipc_hook&>> m_hook_callbacks;
   vector<callback<const ipc_action&>> m_action_callbacks;
+  vector<set_callback> m_set_callbacks;
+  query_callback m_query_callback;
 
   stateflag m_running{false};
+  thread m_thread;
 
   string m_fifo;
-  int m_fd;
+  string m_socket;
+
+  int m_wakefd{-1};
+  int m_epollfd{-1};
+  int m_fifofd{-1};
+  int m_listenfd{-1};
+
+  /**
+   * Pending input of the fifo and the connected clients
+   */
+  string m_fifo_buffer;
+  map<int, client> m_clients;
 };
 
 namespace {
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <moodycamel/blockingconcurrentqueue.h>
+#include <array>
 #include <cstdio>
 
 #include "common.hpp"
+#include "utils/concurrency.hpp"
 #include "utils/factory.hpp"
 
 POLYBAR_NS
@@ -17,10 +20,22 @@ enum class loglevel {
 
 loglevel parse_loglevel_name(string name);
 
+/**
+ * Formatted log message waiting to be written
+ * by the background writer thread
+ */
+struct log_entry {
+  loglevel level{loglevel::NONE};
+  string message;
+};
+
 class logger {
  public:
+  using queue_t = moodycamel::BlockingConcurrentQueue<log_entry>;
+
   explicit logger(loglevel level);
   explicit logger(string level_name) : logger(parse_loglevel_name(level_name)) {}
+  ~logger();
 
   void verbosity(loglevel level);
   void verbosity(string level);
@@ -30,14 +45,14 @@ class logger {
    */
   template <typename... Args>
 #ifdef DEBUG_LOGGER
-  void trace(string message, Args... args) const {
-    output(loglevel::TRACE, message, args...);
+  void trace(const char* message, Args&&... args) const {
+    output(loglevel::TRACE, message, forward<Args>(args)...);
   }
 #else
 #ifdef VERBOSE_TRACELOG
 #undef VERBOSE_TRACELOG
 #endif
-  void trace(string, Args...) const {
+  void trace(const char*, Args&&...) const {
   }
 #endif
 
@@ -46,11 +61,11 @@ class logger {
    */
   template <typename... Args>
 #ifdef VERBOSE_TRACELOG
-  void trace_x(string message, Args... args) const {
-    output(loglevel::TRACE, message, args...);
+  void trace_x(const char* message, Args&&... args) const {
+    output(loglevel::TRACE, message, forward<Args>(args)...);
   }
 #else
-  void trace_x(string, Args...) const {
+  void trace_x(const char*, Args&&...) const {
   }
 #endif
 
@@ -58,24 +73,24 @@ class logger {
    * Output an info message
    */
   template <typename... Args>
-  void info(string message, Args... args) const {
-    output(loglevel::INFO, message, args...);
+  void info(const char* message, Args&&... args) const {
+    output(loglevel::INFO, message, forward<Args>(args)...);
   }
 
   /**
    * Output a warning message
    */
   template <typename... Args>
-  void warn(string message, Args... args) const {
-    output(loglevel::WARNING, message, args...);
+  void warn(const char* message, Args&&... args) const {
+    output(loglevel::WARNING, message, forward<Args>(args)...);
   }
 
   /**
    * Output an error message
    */
   template <typename... Args>
-  void err(string message, Args... args) const {
-    output(loglevel::ERROR, message, args...);
+  void err(const char* message, Args&&... args) const {
+    output(loglevel::ERROR, message, forward<Args>(args)...);
   }
 
  protected:
@@ -87,31 +102,48 @@ class logger {
   /**
    * Convert string to const char*
    */
-  const char* convert(string arg) const {
+  const char* convert(string& arg) const {
+    return arg.c_str();
+  }
+  const char* convert(const string& arg) const {
     return arg.c_str();
   }
 
   /**
-   * Write the log message to the output channel
-   * if the defined verbosity level allows it
+   * Format the log message and hand it over to the
+   * writer thread if the defined verbosity level allows it
+   *
+   * The message is formatted in the calling thread since
+   * the arguments may not outlive the call
    */
   template <typename... Args>
-  void output(loglevel level, string format, Args... values) const {
+  void output(loglevel level, const char* format, Args&&... values) const {
     if (level > m_level)
       return;
 
-    auto prefix = m_prefixes.find(level)->second;
-    auto suffix = m_suffixes.find(level)->second;
+    char buffer[256];
 
 // silence the compiler
 #if defined(__clang__)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wformat-security"
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
 #elif defined(__GNUC__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-security"
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
 #endif
-    dprintf(m_fd, (prefix + format + suffix + "\n").c_str(), convert(values)...);
+    auto length = snprintf(buffer, sizeof(buffer), format, convert(values)...);
+
+    if (length < 0) {
+      return;
+    } else if (static_cast<size_t>(length) < sizeof(buffer)) {
+      write(level, string{buffer, static_cast<size_t>(length)});
+    } else {
+      string message(length, '\0');
+      snprintf(&message[0], message.size() + 1, format, convert(values)...);
+      write(level, move(message));
+    }
 #if defined(__clang__)
 #pragma clang diagnostic pop
 #elif defined(__GNUC__)
@@ -119,6 +151,12 @@ class logger {
 #endif
   }
 
+  void write(loglevel level, string&& message) const;
+  void writer();
+  void process(log_entry&& entry);
+  void flush(const log_entry& entry) const;
+  void flush_repeated();
+
  private:
   /**
    * Logger verbosity level
@@ -131,26 +169,41 @@ class logger {
   int m_fd = STDERR_FILENO;
 
   /**
-   * Loglevel specific prefixes
+   * Loglevel specific prefixes, indexed by loglevel
    */
   // clang-format off
-  map<loglevel, string> m_prefixes {
-    {loglevel::TRACE,   "polybar|trace  "},
-    {loglevel::INFO,    "polybar|info   "},
-    {loglevel::WARNING, "polybar|warn   "},
-    {loglevel::ERROR,   "polybar|error  "},
-  };
+  array<string, 5> m_prefixes {{
+    "",
+    "polybar|error  ",
+    "polybar|warn   ",
+    "polybar|info   ",
+    "polybar|trace  ",
+  }};
 
   /**
-   * Loglevel specific suffixes
+   * Loglevel specific suffixes, indexed by loglevel
    */
-  map<loglevel, string> m_suffixes {
-    {loglevel::TRACE,   ""},
-    {loglevel::INFO,    ""},
-    {loglevel::WARNING, ""},
-    {loglevel::ERROR,   ""},
-  };
+  array<string, 5> m_suffixes {{"\n", "\n", "\n", "\n", "\n"}};
   // clang-format on
+
+  /**
+   * Messages waiting to be written by the writer thread
+   */
+  mutable queue_t m_queue;
+
+  /**
+   * Amount of messages dropped because the queue was full
+   */
+  mutable atomic<size_t> m_dropped{0};
+
+  /**
+   * State used by the writer thread to collapse repeated messages
+   */
+  log_entry m_last;
+  size_t m_repeated{0};
+
+  stateflag m_running{false};
+  thread m_writer;
 };
 
 namespace {
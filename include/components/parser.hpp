@@ -17,6 +17,8 @@ class parser {
   void codeblock(string data);
   size_t text(string data);
 
+  static void validate(const string& data);
+
  protected:
   uint32_t parse_color(string s, uint32_t fallback = 0);
   int8_t parse_fontindex(string s);
@@ -76,6 +76,8 @@ class renderer {
 
   edge m_reserve_at{edge::NONE};
   uint16_t m_reserve;
+
+  unsigned int m_sequence{0};
 };
 
 di::injector<unique_ptr<renderer>> configure_renderer(const bar_settings& bar, const vector<string>& fonts);
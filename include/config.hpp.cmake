@@ -41,7 +41,10 @@
 #define PATH_CPU_INFO "@SETTING_PATH_CPU_INFO@"
 #define PATH_MEMORY_INFO "@SETTING_PATH_MEMORY_INFO@"
 #define PATH_MESSAGING_FIFO "@SETTING_PATH_MESSAGING_FIFO@"
+#define PATH_MESSAGING_SOCKET "@SETTING_PATH_MESSAGING_SOCKET@"
+#define PATH_STATS_DUMP "@SETTING_PATH_STATS_DUMP@"
 #define PATH_TEMPERATURE_INFO "@SETTING_PATH_TEMPERATURE_INFO@"
+#define PATH_TRACE_DUMP "@SETTING_PATH_TRACE_DUMP@"
 
 auto version_details = [](const std::vector<std::string>& args) {
   for (auto&& arg : args) {
@@ -79,7 +82,11 @@ auto print_build_info = [](bool extended = false) {
             << "PATH_BATTERY                " << PATH_BATTERY               << "\n"
             << "PATH_CPU_INFO               " << PATH_CPU_INFO              << "\n"
             << "PATH_MEMORY_INFO            " << PATH_MEMORY_INFO           << "\n"
-            << "PATH_TEMPERATURE_INFO       " << PATH_TEMPERATURE_INFO      << "\n";
+            << "PATH_MESSAGING_FIFO         " << PATH_MESSAGING_FIFO        << "\n"
+            << "PATH_MESSAGING_SOCKET       " << PATH_MESSAGING_SOCKET      << "\n"
+            << "PATH_STATS_DUMP             " << PATH_STATS_DUMP            << "\n"
+            << "PATH_TEMPERATURE_INFO       " << PATH_TEMPERATURE_INFO      << "\n"
+            << "PATH_TRACE_DUMP             " << PATH_TRACE_DUMP            << "\n";
 };
 // clang-format on
 
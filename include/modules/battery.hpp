@@ -2,7 +2,10 @@
 
 #include "common.hpp"
 #include "config.hpp"
-#include "modules/meta/inotify_module.hpp"
+#include "modules/meta/event_module.hpp"
+#include "utils/file.hpp"
+#include "utils/math.hpp"
+#include "utils/uevent.hpp"
 
 POLYBAR_NS
 
@@ -24,15 +27,16 @@ namespace modules {
     RATE,
   };
 
-  class battery_module : public inotify_module<battery_module> {
+  class battery_module : public event_module<battery_module> {
    public:
-    using inotify_module::inotify_module;
+    using event_module::event_module;
 
     void setup();
     void start();
     void teardown();
     void idle();
-    bool on_event(inotify_event* event);
+    bool has_event();
+    bool update();
     string get_format() const;
     bool build(builder* builder, string tag) const;
 
@@ -40,6 +44,8 @@ namespace modules {
     int current_percentage();
     battery_state current_state();
     string current_time();
+    void sample_rate(battery_state state);
+    int read_value(battery_value value);
     void subthread();
 
    private:
@@ -64,13 +70,17 @@ namespace modules {
     label_t m_label_full;
 
     battery_state m_state{battery_state::DISCHARGING};
-    map<battery_value, string> m_valuepath;
+    string m_battery;
+    string m_adapter;
+    map<battery_value, unique_ptr<file_util::pread_reader>> m_values;
+    unique_ptr<uevent_util::monitor> m_uevent;
     std::atomic<int> m_percentage{0};
     int m_fullat{100};
     chrono::duration<double> m_interval;
     chrono::system_clock::time_point m_lastpoll;
     string m_timeformat;
-    int m_unchanged{SKIP_N_UNCHANGED};
+    math_util::moving_average<long> m_rate{1};
+    int m_unchanged{0};
   };
 }
 
@@ -52,6 +52,12 @@ namespace modules {
       return true;
     }
 
+   protected:
+    unique_ptr<bspwm_monitor> create_monitor(const bspwm_util::monitor_state& state, bspwm_monitor* previous,
+        const bspwm_util::monitor_state* previous_state);
+    label_t create_workspace_label(state_ws flag, const string& ws_name, bool focused, size_t index) const;
+    void create_modes(const bspwm_util::monitor_state& state, bspwm_monitor& monitor) const;
+
    private:
     static constexpr auto DEFAULT_WS_ICON = "ws-icon-default";
     static constexpr auto DEFAULT_WS_LABEL = "%icon% %name%";
@@ -65,7 +71,9 @@ namespace modules {
     static constexpr auto EVENT_SCROLL_DOWN = "bwmp";
 
     bspwm_util::connection_t m_subscriber;
+    bspwm_util::report_reader m_reader;
 
+    vector<bspwm_util::monitor_state> m_state;
     vector<unique_ptr<bspwm_monitor>> m_monitors;
 
     map<state_mode, label_t> m_modelabels;
@@ -76,7 +84,6 @@ namespace modules {
     bool m_click = true;
     bool m_scroll = true;
     bool m_pinworkspaces = true;
-    unsigned long m_hash;
 
     // used while formatting output
     size_t m_index = 0;
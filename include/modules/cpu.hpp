@@ -1,22 +1,29 @@
 #pragma once
 
-#include <istream>
-
 #include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  struct cpu_time {
-    unsigned long long user;
-    unsigned long long nice;
-    unsigned long long system;
-    unsigned long long idle;
-    unsigned long long total;
-  };
+  /**
+   * Per core counters read from /proc/stat, stored
+   * as one array per counter indexed by core
+   */
+  struct cpu_times {
+    vector<unsigned long long> idle;
+    vector<unsigned long long> total;
 
-  using cpu_time_t = unique_ptr<cpu_time>;
+    size_t size() const {
+      return total.size();
+    }
+
+    void clear() {
+      idle.clear();
+      total.clear();
+    }
+  };
 
   class cpu_module : public timer_module<cpu_module> {
    public:
@@ -28,7 +35,7 @@ namespace modules {
 
    protected:
     bool read_values();
-    float get_load(size_t core) const;
+    void read_loads();
 
    private:
     static constexpr auto TAG_LABEL = "<label>";
@@ -41,11 +48,16 @@ namespace modules {
     ramp_t m_rampload_core;
     label_t m_label;
 
-    vector<cpu_time_t> m_cputimes;
-    vector<cpu_time_t> m_cputimes_prev;
+    unique_ptr<file_util::pread_reader> m_stat;
+    cpu_times m_cputimes;
+    cpu_times m_cputimes_prev;
 
     float m_total = 0;
     vector<float> m_load;
+
+    size_t m_buckets = 0;
+    int m_spacing = 1;
+    vector<float> m_bucketload;
   };
 }
 
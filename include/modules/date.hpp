@@ -1,6 +1,7 @@
 #pragma once
 
 #include "modules/meta/timer_module.hpp"
+#include "utils/time.hpp"
 
 POLYBAR_NS
 
@@ -19,10 +20,10 @@ namespace modules {
     static constexpr auto TAG_DATE = "<date>";
     static constexpr auto EVENT_TOGGLE = "datetoggle";
 
-    string m_format;
-    string m_formatalt;
+    unique_ptr<time_util::formatter> m_format;
+    unique_ptr<time_util::formatter> m_formatalt;
 
-    char m_buffer[256] = {'\0'};
+    string m_date;
     stateflag m_toggled{false};
   };
 }
@@ -3,6 +3,7 @@
 #include "components/config.hpp"
 #include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/mtab.hpp"
 
 POLYBAR_NS
 
@@ -61,6 +62,7 @@ namespace modules {
     progressbar_t m_barfree;
     ramp_t m_rampcapacity;
 
+    shared_ptr<mtab_util::mountinfo> m_mtab;
     vector<string> m_mountpoints;
     vector<fs_mount_t> m_mounts;
     bool m_fixed = false;
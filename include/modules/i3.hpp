@@ -21,13 +21,22 @@ namespace modules {
     WORKSPACE_URGENT,
   };
 
+  /**
+   * Cached workspace state, the label is only
+   * rebuilt when the resulting flag changes
+   */
   struct i3_workspace {
     int index;
-    i3_flag flag;
+    string name;
+    string output;
+    bool focused{false};
+    bool visible{false};
+    bool urgent{false};
+
+    i3_flag flag{i3_flag::WORKSPACE_NONE};
     label_t label;
 
-    i3_workspace(int index_, i3_flag flag_, label_t&& label_)
-        : index(index_), flag(flag_), label(forward<decltype(label_)>(label_)) {}
+    i3_workspace(int index_, string name_) : index(index_), name(move(name_)) {}
 
     operator bool();
   };
@@ -50,6 +59,14 @@ namespace modules {
       return true;
     }
 
+   protected:
+    bool apply_event(const i3ipc::workspace_event_t& evt);
+    void load_workspaces();
+    bool update_labels();
+    i3_flag current_flag(const i3_workspace& ws) const;
+    label_t create_label(const i3_workspace& ws) const;
+    i3_workspace* find_workspace(const string& name) const;
+
    private:
     static constexpr auto DEFAULT_WS_ICON = "ws-icon-default";
     static constexpr auto DEFAULT_WS_LABEL = "%icon% %name%";
@@ -71,7 +88,16 @@ namespace modules {
     bool m_strip_wsnumbers = false;
     size_t m_wsname_maxlen = 0;
 
+    string m_focused_output;
+    vector<i3ipc::workspace_event_t> m_events;
+    bool m_refresh{true};
+
+    /**
+     * Connection used both for the event subscription and the
+     * requests, guarded since commands are sent from the input thread
+     */
     i3_util::connection_t m_ipc;
+    std::mutex m_ipclock;
   };
 }
 
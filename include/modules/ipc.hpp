@@ -6,6 +6,7 @@
 POLYBAR_NS
 
 struct ipc_hook;  // fwd
+struct ipc_set;   // fwd
 
 namespace modules {
   /**
@@ -22,21 +23,44 @@ namespace modules {
    * received ipc messages. The hook will execute the defined
    * shell script and the resulting output will be used
    * as the module content.
+   *
+   * Content can also be pushed directly using set:<module>:<content>
+   * messages, without executing any command.
+   *
+   * Hooks are executed by a worker thread owned by the module.
+   * Hooks received while a command is running or within the
+   * debounce window replace the pending one, so that a burst of
+   * messages results in a single execution and broadcast.
    */
   class ipc_module : public static_module<ipc_module> {
    public:
     using static_module::static_module;
 
     void setup();
+    void start();
+    void teardown();
     string get_output();
     bool build(builder* builder, string tag) const;
     void on_message(const ipc_hook& msg);
+    bool on_set(const ipc_set& msg);
+
+   protected:
+    void runner();
+    void execute(const hook& hook);
 
    private:
     static constexpr auto TAG_OUTPUT = "<output>";
     vector<unique_ptr<hook>> m_hooks;
     string m_output;
 
+    std::mutex m_hooklock;
+    std::condition_variable m_hookcond;
+    command_util::command_t m_command;
+    const hook* m_pending{nullptr};
+    bool m_push_pending{false};
+    string m_pushed;
+    chrono::milliseconds m_debounce{10};
+
     map<mousebtn, string> m_actions;
   };
 }
@@ -1,9 +1,8 @@
 #pragma once
 
-#include <istream>
-
 #include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -23,6 +22,8 @@ namespace modules {
     static constexpr auto TAG_BAR_USED = "<bar-used>";
     static constexpr auto TAG_BAR_FREE = "<bar-free>";
 
+    unique_ptr<file_util::field_reader> m_meminfo;
+
     label_t m_label;
     progressbar_t m_bar_free;
     map<memtype, progressbar_t> m_bars;
@@ -12,7 +12,9 @@
 #include "utils/concurrency.hpp"
 #include "utils/functional.hpp"
 #include "utils/inotify.hpp"
+#include "utils/stats.hpp"
 #include "utils/string.hpp"
+#include "utils/trace.hpp"
 
 POLYBAR_NS
 
@@ -108,6 +110,8 @@ namespace modules {
     virtual bool handle_event(string cmd) = 0;
     virtual bool receive_events() const = 0;
 
+    virtual const stats_util::module_counters& stats() const = 0;
+
     virtual void set_update_cb(callback<>&& cb) = 0;
     virtual void set_stop_cb(callback<>&& cb) = 0;
   };
@@ -133,11 +137,13 @@ namespace modules {
     string contents();
     bool handle_event(string cmd);
     bool receive_events() const;
+    const stats_util::module_counters& stats() const;
 
    protected:
     void broadcast();
     void idle();
     void sleep(chrono::duration<double> sleep_duration);
+    void sleep_until(chrono::system_clock::time_point wakeup_time);
     void wakeup();
     string get_format() const;
     string get_output();
@@ -161,6 +167,8 @@ namespace modules {
     vector<thread> m_threads;
     thread m_mainthread;
 
+    stats_util::module_counters m_stats;
+
    private:
     stateflag m_enabled{true};
     string m_cache;
@@ -107,6 +107,11 @@ namespace modules {
     return false;
   }
 
+  template <typename Impl>
+  const stats_util::module_counters& module<Impl>::stats() const {
+    return m_stats;
+  }
+
   // }}}
   // module<Impl> protected {{{
 
@@ -116,7 +121,18 @@ namespace modules {
       return;
     }
 
-    m_cache = CAST_MOD(Impl)->get_output();
+    {
+      trace_util::span span{"module", "get_output", m_name};
+      auto output = m_stats.output.measure([&] { return CAST_MOD(Impl)->get_output(); });
+
+      m_stats.broadcasts++;
+      m_stats.output_bytes += output.size();
+
+      if (output == m_cache)
+        m_stats.unchanged++;
+
+      m_cache = move(output);
+    }
 
     if (m_update_callback)
       m_update_callback();
@@ -135,6 +151,17 @@ namespace modules {
     m_sleephandler.wait_for(lck, sleep_duration);
   }
 
+  /**
+   * Sleep until the given wall clock time, the deadline
+   * is absolute so that it isn't affected by the time
+   * spent before going to sleep or by clock adjustments
+   */
+  template <typename Impl>
+  void module<Impl>::sleep_until(chrono::system_clock::time_point wakeup_time) {
+    std::unique_lock<std::mutex> lck(m_sleeplock);
+    m_sleephandler.wait_until(lck, wakeup_time);
+  }
+
   template <typename Impl>
   void module<Impl>::wakeup() {
     m_log.trace("%s: Release sleep lock", name());
@@ -32,7 +32,9 @@ namespace modules {
             continue;
           if (!CONST_MOD(Impl).running())
             break;
-          if (!CAST_MOD(Impl)->update())
+
+          trace_util::span span{"module", "update", this->m_name};
+          if (!this->m_stats.update.measure([&] { return CAST_MOD(Impl)->update(); }))
             continue;
 
           CAST_MOD(Impl)->broadcast();
@@ -21,7 +21,14 @@ namespace modules {
    protected:
     interval_t m_interval{1};
 
+    /**
+     * Wake up on multiples of the interval on the wall clock
+     * instead of sleeping the interval after each update
+     */
+    bool m_aligned{false};
+
     void runner();
+    chrono::system_clock::time_point next_tick() const;
   };
 }
 
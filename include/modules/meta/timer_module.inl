@@ -17,10 +17,14 @@ namespace modules {
       while (CONST_MOD(Impl).running()) {
         std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
         {
-          if (CAST_MOD(Impl)->update())
+          trace_util::span span{"module", "update", this->m_name};
+          if (this->m_stats.update.measure([&] { return CAST_MOD(Impl)->update(); }))
             CAST_MOD(Impl)->broadcast();
         }
-        CAST_MOD(Impl)->sleep(m_interval);
+        if (m_aligned)
+          CAST_MOD(Impl)->sleep_until(next_tick());
+        else
+          CAST_MOD(Impl)->sleep(m_interval);
       }
     } catch (const module_error& err) {
       CAST_MOD(Impl)->halt(err.what());
@@ -29,6 +33,20 @@ namespace modules {
     }
   }
 
+  /**
+   * Get the next wall clock time that is a multiple of the interval
+   */
+  template <typename Impl>
+  chrono::system_clock::time_point timer_module<Impl>::next_tick() const {
+    auto now = chrono::system_clock::now();
+    auto interval = chrono::duration_cast<chrono::system_clock::duration>(m_interval);
+
+    if (interval.count() <= 0)
+      return now;
+
+    return now - now.time_since_epoch() % interval + interval;
+  }
+
   // }}}
 }
 
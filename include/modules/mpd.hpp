@@ -17,6 +17,7 @@ namespace modules {
   class mpd_module : public event_module<mpd_module> {
    public:
     using event_module::event_module;
+    ~mpd_module();
 
     void setup();
     void teardown();
@@ -76,8 +77,14 @@ namespace modules {
     string m_toggle_on_color;
     string m_toggle_off_color;
 
-    chrono::system_clock::time_point m_lastsync;
     float m_synctime = 1.0f;
+    unsigned m_lastelapsed = 0;
+
+    // Set when the song labels need to be fetched again
+    bool m_refresh = true;
+
+    // Used to interrupt the wait for idle events when stopping
+    int m_wakefd = -1;
 
     string m_progress_fill;
     string m_progress_empty;
@@ -20,7 +20,9 @@ namespace modules {
     bool build(builder* builder, string tag) const;
 
    protected:
+    net::network* adapter() const;
     void subthread_routine();
+    void monitor_routine();
 
    private:
     static constexpr auto FORMAT_CONNECTED = "format-connected";
@@ -41,6 +43,8 @@ namespace modules {
     animation_t m_animation_packetloss;
     map<connection_state, label_t> m_label;
 
+    thread m_monitorthread;
+
     stateflag m_connected{false};
     stateflag m_packetloss{false};
 
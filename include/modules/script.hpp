@@ -33,7 +33,15 @@ namespace modules {
 
     string m_exec;
     bool m_tail = false;
+    bool m_persistent = false;
+    chrono::milliseconds m_timeout{0};
+    chrono::milliseconds m_stagger{0};
+    shared_ptr<command_util::shell_pool> m_shells;
+    command_util::shell_handle m_shell;
+    shared_ptr<concurrency_util::semaphore> m_slots;
     chrono::duration<double> m_interval{0};
+    chrono::milliseconds m_mininterval{0};
+    chrono::steady_clock::time_point m_lastbroadcast;
     size_t m_maxlen = 0;
     bool m_ellipsis = true;
     map<mousebtn, string> m_actions;
@@ -4,6 +4,7 @@
 
 #include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
@@ -29,6 +30,7 @@ namespace modules {
     ramp_t m_ramp;
 
     string m_path;
+    unique_ptr<file_util::pread_reader> m_file;
     int m_zone = 0;
     int m_tempwarn = 0;
     int m_temp = 0;
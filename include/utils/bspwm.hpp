@@ -5,6 +5,7 @@
 
 #include "common.hpp"
 #include "config.hpp"
+#include "utils/bspwm_report.hpp"
 #include "utils/socket.hpp"
 #include "utils/string.hpp"
 #include "x11/connection.hpp"
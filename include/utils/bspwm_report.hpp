@@ -0,0 +1,51 @@
+#pragma once
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace bspwm_util {
+  /**
+   * Desktop item of a report, the flag is the raw
+   * report character (e.g. 'F' for focused occupied)
+   */
+  struct desktop_state {
+    char flag;
+    string name;
+  };
+
+  /**
+   * Monitor item of a report along with its desktops
+   * and the layout, state and flags of its focused node
+   */
+  struct monitor_state {
+    string name;
+    bool focused{false};
+    vector<desktop_state> desktops;
+    char layout{'\0'};
+    char state{'\0'};
+    string flags;
+  };
+
+  bool operator==(const desktop_state& a, const desktop_state& b);
+  bool operator==(const monitor_state& a, const monitor_state& b);
+
+  /**
+   * Accumulates the data received from the subscriber and
+   * extracts the most recent complete report, keeping the
+   * trailing partial report until the rest of it arrives
+   */
+  class report_reader {
+   public:
+    bool feed(const char* data, size_t length);
+    const string& report() const;
+
+   protected:
+    string m_buffer;
+    string m_report;
+  };
+
+  bool parse_report(const string& report, vector<monitor_state>& monitors);
+}
+
+POLYBAR_NS_END
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 #include "common.hpp"
 #include "components/logger.hpp"
 #include "utils/concurrency.hpp"
+#include "utils/factory.hpp"
 #include "utils/functional.hpp"
+#include "utils/io.hpp"
 
 POLYBAR_NS
 
@@ -15,6 +21,11 @@ namespace command_util {
    * Wrapper used to execute command in a subprocess.
    * In-/output streams are opened to enable ipc.
    *
+   * The process is created using posix_spawn, which avoids
+   * copying the page tables of the whole process. Commands
+   * without any shell syntax are executed directly instead
+   * of being passed to `sh -c`.
+   *
    * Example usage:
    *
    * @code cpp
@@ -46,31 +57,42 @@ namespace command_util {
     ~command();
 
     int exec(bool wait_for_completion = true);
-    void terminate();
+    void terminate(std::chrono::milliseconds grace = std::chrono::seconds{1});
     bool is_running();
     int wait();
+    bool wait(std::chrono::milliseconds timeout);
 
     void tail(callback<string> callback);
+    bool tail(callback<string> callback, std::chrono::milliseconds timeout);
     int writeline(string data);
     string readline();
+    bool readline(string& line, int timeout_ms);
+    bool timed_out();
 
     int get_stdout(int c);
     int get_stdin(int c);
     pid_t get_pid();
     int get_exit_status();
 
+    static bool needs_shell(const string& cmd);
+
+   protected:
+    void spawn(const vector<string>& args);
+
    protected:
     const logger& m_log;
 
     string m_cmd;
+    vector<string> m_args;
 
     int m_stdout[2];
     int m_stdin[2];
 
-    pid_t m_forkpid;
-    int m_forkstatus;
+    pid_t m_forkpid{-1};
+    int m_forkstatus{0};
 
     concurrency_util::spin_lock m_pipelock;
+    unique_ptr<io_util::line_reader> m_reader;
   };
 
   using command_t = unique_ptr<command>;
@@ -79,6 +101,79 @@ namespace command_util {
   command_t make_command(Args&&... args) {
     return make_unique<command>(configure_logger().create<const logger&>(), forward<Args>(args)...);
   }
+
+  /**
+   * Long running shell executing the commands written to its
+   * input. Each command runs in a subshell and its output is
+   * followed by a marker line holding the exit status
+   */
+  class shell {
+   public:
+    explicit shell(const logger& logger);
+
+    int run(const string& cmd, std::chrono::milliseconds timeout, const callback<string>& callback);
+    void interrupt();
+    void kill();
+
+   protected:
+    const logger& m_log;
+    command_t m_command;
+    string m_marker;
+    atomic<bool> m_interrupted{false};
+  };
+
+  class shell_pool;
+
+  /**
+   * Caller owned handle used to interrupt the
+   * command it's running in one of the pooled shells,
+   * the state is guarded by the mutex of the pool
+   */
+  class shell_handle : public non_copyable_mixin<shell_handle> {
+   protected:
+    friend class shell_pool;
+
+    shell* m_shell{nullptr};
+    bool m_interrupted{false};
+  };
+
+  /**
+   * Pool of persistent shells shared by all modules, avoids
+   * spawning a new process for every executed command
+   *
+   * Shells that time out or exit are killed and replaced
+   * by a new one the next time a shell is needed
+   */
+  class shell_pool {
+   public:
+    explicit shell_pool(const logger& logger, size_t size) : m_log(logger), m_size(size) {}
+
+    int run(const string& cmd, std::chrono::milliseconds timeout, const callback<string>& callback,
+        shell_handle* handle = nullptr);
+    void interrupt(shell_handle& handle);
+
+   protected:
+    unique_ptr<shell> acquire(shell_handle* handle);
+    void release(unique_ptr<shell>&& sh, shell_handle* handle = nullptr);
+
+   private:
+    const logger& m_log;
+    const size_t m_size;
+    size_t m_spawned{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    vector<unique_ptr<shell>> m_idle;
+  };
+
+  /**
+   * Get the shell pool shared by all modules,
+   * the size is set by the first caller
+   */
+  inline shared_ptr<shell_pool> get_shell_pool(size_t size) {
+    return factory_util::generic_singleton<shell_pool, const logger&, size_t>(
+        configure_logger().create<const logger&>(), size);
+  }
 }
 
 using command = command_util::command;
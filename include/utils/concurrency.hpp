@@ -1,6 +1,8 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
@@ -68,6 +70,46 @@ namespace concurrency_util {
    protected:
     std::atomic_flag m_locked{false};
   };
+
+  /**
+   * Counting semaphore, lock() blocks until one of
+   * the given amount of slots is available so it
+   * can be used together with std::lock_guard, or
+   * std::unique_lock for timed waits
+   */
+  class semaphore : public non_copyable_mixin<semaphore> {
+   public:
+    explicit semaphore(size_t slots) : m_slots(slots) {}
+
+    void lock() {
+      std::unique_lock<std::mutex> guard(m_mutex);
+      m_cond.wait(guard, [&] { return m_slots > 0; });
+      m_slots--;
+    }
+
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& timeout) {
+      std::unique_lock<std::mutex> guard(m_mutex);
+      if (!m_cond.wait_for(guard, timeout, [&] { return m_slots > 0; })) {
+        return false;
+      }
+      m_slots--;
+      return true;
+    }
+
+    void unlock() {
+      {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_slots++;
+      }
+      m_cond.notify_one();
+    }
+
+   protected:
+    size_t m_slots;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+  };
 }
 
 POLYBAR_NS_END
@@ -27,6 +27,51 @@ namespace file_util {
     string m_mode;
   };
 
+  /**
+   * Keeps a file open and reads it from the start into a
+   * reused buffer on every call, meant for files in procfs
+   * and sysfs that are read repeatedly
+   */
+  class pread_reader {
+   public:
+    explicit pread_reader(const string& path, size_t size = 4096);
+    ~pread_reader();
+
+    const char* read(size_t* length = nullptr);
+
+   protected:
+    int m_fd{-1};
+    string m_path;
+    vector<char> m_buffer;
+  };
+
+  /**
+   * Reads named numeric fields from files formatted as
+   * lines of "Key: value" or "key value", like the ones
+   * found in procfs (e.g. /proc/meminfo)
+   *
+   * The offset of each field is remembered after the first
+   * lookup and only searched for again if the key isn't
+   * found at the cached offset anymore
+   */
+  class field_reader : public pread_reader {
+   public:
+    explicit field_reader(const string& path, vector<string> keys);
+
+    bool read();
+    unsigned long long get(size_t index) const;
+    bool has(size_t index) const;
+
+   protected:
+    size_t find(const char* contents, size_t length, const string& key) const;
+
+   private:
+    vector<string> m_keys;
+    vector<size_t> m_offsets;
+    vector<unsigned long long> m_values;
+    vector<bool> m_found;
+  };
+
   bool exists(string filename);
   string get_contents(string filename);
   void set_block(int fd);
@@ -21,6 +21,38 @@ namespace io_util {
   bool poll_write(int fd, int timeout_ms = 1);
 
   bool interrupt_read(int write_fd);
+
+  /**
+   * Line reader that reads the data in chunks
+   * instead of issuing one read call per byte
+   *
+   * Example usage:
+   * @code cpp
+   *   io_util::line_reader reader{fd};
+   *   string line;
+   *   while (reader.readline(line)) {
+   *     ...
+   *   }
+   * @endcode
+   */
+  class line_reader {
+   public:
+    explicit line_reader(int fd) : m_fd(fd) {}
+
+    bool readline(string& line, int timeout_ms = -1);
+    bool buffered() const;
+    bool timed_out() const;
+
+   protected:
+    bool fill(int timeout_ms);
+
+   private:
+    int m_fd;
+    string m_buffer;
+    size_t m_offset{0};
+    bool m_eof{false};
+    bool m_timedout{false};
+  };
 }
 
 POLYBAR_NS_END
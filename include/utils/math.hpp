@@ -52,6 +52,48 @@ namespace math_util {
     else
       return cap<ReturnType>(percentage * (max_value - min_value) / 100.0f, 0.0f, max_value - min_value) + min_value;
   }
+
+  /**
+   * Average of the last N samples, kept in a ring
+   * buffer along with their running sum so that
+   * adding a sample doesn't require a full pass
+   */
+  template <typename ValueType>
+  class moving_average {
+   public:
+    explicit moving_average(size_t window) : m_samples(std::max<size_t>(window, 1)) {}
+
+    void push(ValueType value) {
+      if (m_count == m_samples.size()) {
+        m_sum -= m_samples[m_next];
+      } else {
+        m_count++;
+      }
+      m_sum += value;
+      m_samples[m_next] = value;
+      m_next = (m_next + 1) % m_samples.size();
+    }
+
+    void clear() {
+      m_sum = ValueType{};
+      m_next = 0;
+      m_count = 0;
+    }
+
+    double get() const {
+      return m_count ? static_cast<double>(m_sum) / m_count : 0.0;
+    }
+
+    size_t count() const {
+      return m_count;
+    }
+
+   private:
+    vector<ValueType> m_samples;
+    ValueType m_sum{};
+    size_t m_next{0};
+    size_t m_count{0};
+  };
 }
 
 POLYBAR_NS_END
@@ -1,36 +1,52 @@
 #pragma once
 
-#include <mntent.h>
+#include <mutex>
 
 #include "common.hpp"
+#include "utils/factory.hpp"
+#include "utils/file.hpp"
 
 POLYBAR_NS
 
 namespace mtab_util {
   /**
-   * Wrapper for reading mtab entries
+   * Single entry of the mount table
    */
-  class reader {
+  struct mount_entry {
+    string mountpoint;
+    string type;
+    string fsname;
+  };
+
+  /**
+   * Cached copy of the mount table parsed from mountinfo
+   *
+   * The kernel flags the file with POLLPRI whenever something gets
+   * mounted or unmounted, so the table is only parsed again after
+   * such an event instead of on every lookup
+   */
+  class mountinfo : public file_util::pread_reader {
    public:
-    explicit reader() {
-      if ((m_ptr = setmntent("/etc/mtab", "r")) == nullptr) {
-        throw system_error("Failed to read mtab");
-      }
-    }
-
-    ~reader() {
-      if (m_ptr != nullptr) {
-        endmntent(m_ptr);
-      }
-    }
-
-    bool next(mntent** dst) {
-      return (*dst = getmntent(m_ptr)) != nullptr;
-    }
+    explicit mountinfo(const string& path = "/proc/self/mountinfo") : pread_reader(path, 16384) {}
+
+    bool find(const string& mountpoint, mount_entry& entry);
 
    protected:
-    FILE* m_ptr = nullptr;
+    bool changed() const;
+    void parse(const char* contents);
+
+   private:
+    std::mutex m_mutex;
+    bool m_parsed{false};
+    map<string, mount_entry> m_mounts;
   };
+
+  /**
+   * Get the mount table shared by all modules
+   */
+  inline shared_ptr<mountinfo> get_mountinfo() {
+    return factory_util::generic_singleton<mountinfo>();
+  }
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <iosfwd>
+
+#include "common.hpp"
+#include "utils/concurrency.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+namespace stats_util {
+  using counter = atomic<uint64_t>;
+
+  /**
+   * Latency histogram using power of two buckets,
+   * bucket N holds the samples taking [2^(N-1), 2^N)
+   * microseconds and the last bucket holds the rest
+   */
+  class histogram {
+   public:
+    static constexpr size_t BUCKETS{20};
+
+    void record(uint64_t usec);
+
+    /**
+     * Run given function and record the time it took
+     */
+    template <typename Fn>
+    decltype(auto) measure(const Fn& fn) {
+      scoped_timer timer{*this};
+      return fn();
+    }
+
+    uint64_t count() const;
+    uint64_t total() const;
+    uint64_t bucket(size_t index) const;
+    void write_json(std::ostream& out) const;
+
+   protected:
+    /**
+     * Records the time elapsed until destruction
+     */
+    class scoped_timer {
+     public:
+      explicit scoped_timer(histogram& hist) : m_hist(hist), m_start(chrono::steady_clock::now()) {}
+      ~scoped_timer() {
+        auto elapsed = chrono::steady_clock::now() - m_start;
+        m_hist.record(chrono::duration_cast<chrono::microseconds>(elapsed).count());
+      }
+
+     private:
+      histogram& m_hist;
+      chrono::steady_clock::time_point m_start;
+    };
+
+   private:
+    array<counter, BUCKETS> m_buckets{};
+    counter m_count{0};
+    counter m_total{0};
+  };
+
+  /**
+   * Counters tracked by each module
+   */
+  struct module_counters {
+    histogram update;
+    histogram output;
+    counter output_bytes{0};
+    counter broadcasts{0};
+    counter unchanged{0};
+
+    void write_json(std::ostream& out) const;
+  };
+
+  /**
+   * Process wide counters
+   */
+  extern counter frames_rendered;
+  extern counter frames_skipped;
+  // Includes the requests of all threads sharing the X connection
+  extern counter x_connection_requests;
+
+  void write_json(std::ostream& out, const vector<pair<string, const module_counters*>>& modules);
+}
+
+POLYBAR_NS_END
@@ -23,6 +23,7 @@ namespace string_util {
   string squeeze(const string& haystack, char needle);
   string strip(const string& haystack, char needle);
   string strip_trailing_newline(const string& haystack);
+  string escape_json(const string& haystack);
   string ltrim(const string& haystack, char needle);
   string rtrim(const string& haystack, char needle);
   string trim(const string& haystack, char needle);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <chrono>
+#include <ctime>
+#include <limits>
 
 #include "common.hpp"
 
@@ -18,6 +20,36 @@ namespace time_util {
     auto finish = clock_t::now();
     return chrono::duration_cast<Dur>(finish - start).count();
   }
+
+  /**
+   * Formats timestamps using a strftime format that gets split
+   * into static text and conversions once, so that only the
+   * conversions that can have changed are formatted on each call
+   *
+   * The broken down local time is only recomputed when the
+   * minute changes, within a minute only the seconds are updated
+   */
+  class formatter {
+   public:
+    explicit formatter(const string& format);
+
+    const string& format(std::time_t time);
+    bool seconds() const;
+
+   protected:
+    struct field {
+      string spec;
+      bool dynamic;
+      bool seconds;
+      string value;
+    };
+
+   private:
+    vector<field> m_fields;
+    std::tm m_tm{};
+    std::time_t m_minute{std::numeric_limits<std::time_t>::min()};
+    string m_result;
+  };
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <iosfwd>
+
+#include "common.hpp"
+#include "utils/concurrency.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+namespace trace_util {
+  /**
+   * Amount of events kept per thread, older events
+   * get overwritten once the buffer is full
+   */
+  static constexpr size_t BUFFER_SIZE{2048};
+
+  /**
+   * Amount of buffers of exited threads kept until the next dump,
+   * the oldest ones get dropped when threads come and go often
+   */
+  static constexpr size_t MAX_RETIRED_BUFFERS{16};
+
+  /**
+   * Fixed size record of a completed span
+   */
+  struct event {
+    char name[48];
+    const char* category;
+    uint64_t start;
+    uint64_t duration;
+  };
+
+  /**
+   * Ring buffer holding the events recorded by a single thread
+   */
+  class buffer {
+   public:
+    explicit buffer(long tid) : m_tid(tid) {}
+
+    void push(const event& evt);
+    vector<event> events();
+
+    long tid() const;
+    void retire();
+    bool retired() const;
+
+   protected:
+    const long m_tid;
+    stateflag m_retired{false};
+
+    concurrency_util::spin_lock m_lock;
+    array<event, BUFFER_SIZE> m_events;
+    size_t m_next{0};
+    size_t m_count{0};
+  };
+
+  /**
+   * Records the time spent between construction and
+   * destruction into the calling thread's buffer
+   *
+   * Example usage:
+   * @code cpp
+   *   {
+   *     trace_util::span span{"module", "update", name()};
+   *     update();
+   *   }
+   * @endcode
+   */
+  class span {
+   public:
+    explicit span(const char* category, const char* name, const char* detail = nullptr);
+    explicit span(const char* category, const char* name, const string& detail)
+        : span(category, name, detail.c_str()) {}
+    ~span();
+
+   protected:
+    bool m_active{false};
+    event m_event;
+  };
+
+  void enable(bool state = true);
+  bool enabled();
+
+  uint64_t now();
+  size_t dump(const string& path);
+  size_t dump(std::ostream& out);
+}
+
+POLYBAR_NS_END
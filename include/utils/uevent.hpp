@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace uevent_util {
+  /**
+   * Kernel uevent, e.g. "change@/devices/.../BAT0" followed
+   * by its environment (ACTION=change, SUBSYSTEM=power_supply, ...)
+   */
+  struct event {
+    string action;
+    string devpath;
+    map<string, string> env;
+
+    string get(const string& key) const;
+  };
+
+  bool parse(const char* data, size_t length, event& evt);
+
+  /**
+   * Receives the kernel uevents of the given subsystem
+   * through a NETLINK_KOBJECT_UEVENT socket
+   */
+  class monitor {
+   public:
+    explicit monitor(string subsystem);
+    ~monitor();
+
+    bool poll(int timeout_ms);
+    bool receive(event& evt);
+
+   protected:
+    int m_fd{-1};
+    string m_subsystem;
+  };
+}
+
+POLYBAR_NS_END
@@ -1,3 +1,5 @@
+#include <poll.h>
+#include <unistd.h>
 #include <thread>
 
 #include "adapters/mpd.hpp"
@@ -152,6 +154,35 @@ namespace mpd {
     m_idle = true;
   }
 
+  /**
+   * Enter idle mode and wait until the server reports a change,
+   * the timeout is reached or the interrupt fd becomes readable
+   *
+   * @return true if there are idle events to collect using noidle()
+   */
+  bool mpdconnection::wait(int timeout_ms, int interrupt_fd) {
+    idle();
+
+    struct pollfd fds[2];
+    fds[0].fd = m_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = interrupt_fd;
+    fds[1].events = POLLIN;
+
+    if (::poll(fds, interrupt_fd != -1 ? 2 : 1, timeout_ms) <= 0) {
+      return false;
+    }
+
+    if (interrupt_fd != -1 && fds[1].revents & POLLIN) {
+      uint64_t value;
+      if (::read(interrupt_fd, &value, sizeof(value)) == -1) {
+        m_log.trace("mpdconnection.wait: Failed to clear interrupt");
+      }
+    }
+
+    return fds[0].revents & (POLLIN | POLLHUP | POLLERR);
+  }
+
   int mpdconnection::noidle() {
     check_connection(m_connection.get());
     int flags = 0;
@@ -326,6 +357,7 @@ namespace mpd {
     m_repeat = mpd_status_get_repeat(m_status.get());
     m_single = mpd_status_get_single(m_status.get());
     m_elapsed_time = mpd_status_get_elapsed_time(m_status.get());
+    m_elapsed_time_ms = mpd_status_get_elapsed_ms(m_status.get());
     m_total_time = mpd_status_get_total_time(m_status.get());
   }
 
@@ -335,8 +367,6 @@ namespace mpd {
 
     fetch_data(connection);
 
-    m_elapsed_time_ms = m_elapsed_time * 1000;
-
     auto state = mpd_status_get_state(m_status.get());
 
     switch (state) {
@@ -354,12 +384,18 @@ namespace mpd {
     }
   }
 
-  void mpdstatus::update_timer() {
-    auto diff = chrono::system_clock::now() - m_updated_at;
-    auto dur = chrono::duration_cast<chrono::milliseconds>(diff);
-    m_elapsed_time_ms += dur.count();
-    m_elapsed_time = m_elapsed_time_ms / 1000 + 0.5f;
-    m_updated_at = chrono::system_clock::now();
+  /**
+   * Interpolate the elapsed time since the status was fetched
+   *
+   * @return true if the elapsed seconds changed
+   */
+  bool mpdstatus::update_timer() {
+    auto elapsed = get_elapsed_ms() / 1000;
+    if (elapsed == m_elapsed_time) {
+      return false;
+    }
+    m_elapsed_time = elapsed;
+    return true;
   }
 
   bool mpdstatus::random() const {
@@ -394,6 +430,18 @@ namespace mpd {
     return m_elapsed_time;
   }
 
+  /**
+   * Get elapsed time in milliseconds, interpolated
+   * from the last fetch while playing
+   */
+  unsigned long mpdstatus::get_elapsed_ms() const {
+    if (m_state != mpdstate::PLAYING) {
+      return m_elapsed_time_ms;
+    }
+    auto diff = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now() - m_updated_at);
+    return m_elapsed_time_ms + diff.count();
+  }
+
   unsigned mpdstatus::get_elapsed_percentage() {
     if (m_total_time == 0)
       return 0;
@@ -5,11 +5,14 @@
 #include <limits.h>
 #include <linux/ethtool.h>
 #include <linux/if_link.h>
+#include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <netinet/ip_icmp.h>
 #include <signal.h>
 #include <sys/socket.h>
+#include <fnmatch.h>
 #include <cerrno>
 #include <cstdio>
 #include <fstream>
@@ -23,7 +26,10 @@
 #include "common.hpp"
 #include "config.hpp"
 #include "utils/command.hpp"
+#include "utils/factory.hpp"
 #include "utils/file.hpp"
+#include "utils/io.hpp"
+#include "utils/scope.hpp"
 #include "utils/string.hpp"
 
 POLYBAR_NS
@@ -36,17 +42,294 @@ namespace net {
     return file_util::exists("/sys/class/net/" + ifname + "/wireless");
   }
 
+  /**
+   * Test if the interface name contains wildcards, such
+   * names select all interfaces matching the pattern
+   */
+  bool is_interface_pattern(const string& ifname) {
+    return ifname.find_first_of("*?[") != string::npos;
+  }
+
+  // class : sampler {{{
+
+  sampler::sampler() : m_file("/proc/net/dev") {}
+
+  /**
+   * Get the counters of all interfaces matching the pattern,
+   * stamped with the time the shared sample was taken
+   *
+   * @return false if the counters could not be read
+   */
+  bool sampler::read(const string& pattern, link_activity& activity) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    refresh();
+
+    activity.interfaces.clear();
+    activity.time = m_sampled;
+
+    for (auto&& iface : m_interfaces) {
+      if (fnmatch(pattern.c_str(), iface.first.c_str(), 0) == 0) {
+        activity.interfaces.emplace_back(iface);
+      }
+    }
+
+    return m_valid;
+  }
+
+  /**
+   * Get the names of all interfaces matching the pattern
+   */
+  vector<string> sampler::interfaces(const string& pattern) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    refresh();
+
+    vector<string> names;
+    for (auto&& iface : m_interfaces) {
+      if (fnmatch(pattern.c_str(), iface.first.c_str(), 0) == 0) {
+        names.emplace_back(iface.first);
+      }
+    }
+    return names;
+  }
+
+  /**
+   * Read the counters of all interfaces unless they were read
+   * very recently, modules updating in the same tick share one
+   * sample instead of reading the file each
+   */
+  void sampler::refresh() {
+    auto now = chrono::steady_clock::now();
+    if (now - m_sampled < chrono::milliseconds{100}) {
+      return;
+    }
+
+    auto pos = m_file.read();
+    m_sampled = now;
+    m_valid = pos != nullptr;
+    m_interfaces.clear();
+
+    if (pos == nullptr) {
+      return;
+    }
+
+    // Each line after the two header lines is formatted as "name: rx_bytes
+    // rx_packets rx_errs rx_drop rx_fifo rx_frame rx_compressed rx_multicast tx_bytes ..."
+    for (int header = 0; header < 2 && (pos = strchr(pos, '\n')) != nullptr; header++) {
+      pos++;
+    }
+
+    while (pos != nullptr && *pos != '\0') {
+      auto colon = strchr(pos, ':');
+      if (colon == nullptr) {
+        break;
+      }
+
+      while (*pos == ' ') {
+        pos++;
+      }
+
+      string name{pos, static_cast<size_t>(colon - pos)};
+      char* end{nullptr};
+      link_counters values{};
+
+      values.received = strtoull(colon + 1, &end, 10);
+      for (int field = 0; field < 7; field++) {
+        strtoull(end, &end, 10);
+      }
+      values.transmitted = strtoull(end, &end, 10);
+
+      m_interfaces.emplace_back(move(name), values);
+
+      if ((pos = strchr(end, '\n')) != nullptr) {
+        pos++;
+      }
+    }
+  }
+
+  /**
+   * Get the sampler shared by all network modules
+   */
+  shared_ptr<sampler> get_sampler() {
+    return factory_util::generic_singleton<sampler>();
+  }
+
+  // }}}
+  // class : link_monitor {{{
+
+  /**
+   * Subscribe to link and ipv4 address changes
+   * and request the current addresses
+   */
+  link_monitor::link_monitor(filter_t&& filter) : m_filter(forward<filter_t>(filter)) {
+    if ((m_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE)) == -1)
+      throw network_error("Failed to open netlink socket");
+
+    struct sockaddr_nl addr {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+
+    if (bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      close(m_fd);
+      throw network_error("Failed to bind netlink socket");
+    }
+
+    request_addresses();
+  }
+
+  link_monitor::~link_monitor() {
+    if (m_fd != -1)
+      close(m_fd);
+  }
+
+  /**
+   * Wait for link or address changes
+   *
+   * @return true if the interface changed
+   */
+  bool link_monitor::wait(int timeout_ms) {
+    if (!io_util::poll_read(m_fd, timeout_ms))
+      return false;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return process();
+  }
+
+  /**
+   * Get the current ipv4 address of the interface, the
+   * latest address added if there are several interfaces
+   */
+  string link_monitor::ip() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    process();
+    return m_ip;
+  }
+
+  /**
+   * Ask the kernel to dump all ipv4 addresses, the replies
+   * are handled like any other address notification
+   */
+  void link_monitor::request_addresses() {
+    struct {
+      struct nlmsghdr header;
+      struct ifaddrmsg msg;
+    } request{};
+
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(request.msg));
+    request.header.nlmsg_type = RTM_GETADDR;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.msg.ifa_family = AF_INET;
+
+    send(m_fd, &request, request.header.nlmsg_len, 0);
+  }
+
+  /**
+   * Handle all pending netlink messages without blocking
+   *
+   * @return true if any of them concerned the interface
+   */
+  bool link_monitor::process() {
+    alignas(struct nlmsghdr) char buffer[8192];
+    bool changed{false};
+    ssize_t bytes;
+
+    while ((bytes = recv(m_fd, buffer, sizeof(buffer), MSG_DONTWAIT)) != 0) {
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1 && errno == ENOBUFS) {
+        // Notifications were dropped, start over with a fresh dump,
+        // the removal of the current address may have been lost
+        m_ip.clear();
+        request_addresses();
+        changed = true;
+        continue;
+      } else if (bytes == -1) {
+        break;
+      }
+
+      auto len = static_cast<size_t>(bytes);
+      for (auto msg = reinterpret_cast<struct nlmsghdr*>(buffer); NLMSG_OK(msg, len); msg = NLMSG_NEXT(msg, len)) {
+        if (msg->nlmsg_type == RTM_NEWLINK || msg->nlmsg_type == RTM_DELLINK) {
+          auto info = static_cast<struct ifinfomsg*>(NLMSG_DATA(msg));
+          const char* ifname{nullptr};
+          auto attr_len = IFLA_PAYLOAD(msg);
+
+          for (auto attr = IFLA_RTA(info); RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+            if (attr->rta_type == IFLA_IFNAME) {
+              ifname = static_cast<const char*>(RTA_DATA(attr));
+            }
+          }
+
+          changed |= m_filter(info->ifi_index, ifname);
+          continue;
+        } else if (msg->nlmsg_type != RTM_NEWADDR && msg->nlmsg_type != RTM_DELADDR) {
+          continue;
+        }
+
+        auto info = static_cast<struct ifaddrmsg*>(NLMSG_DATA(msg));
+        if (info->ifa_family != AF_INET) {
+          continue;
+        }
+
+        char ip_buffer[INET_ADDRSTRLEN]{'\0'};
+        const char* ifname{nullptr};
+        auto attr_len = IFA_PAYLOAD(msg);
+
+        for (auto attr = IFA_RTA(info); RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+          // IFA_LOCAL holds the local address of point-to-point interfaces
+          if (attr->rta_type == IFA_LOCAL || (attr->rta_type == IFA_ADDRESS && ip_buffer[0] == '\0')) {
+            inet_ntop(AF_INET, RTA_DATA(attr), ip_buffer, sizeof(ip_buffer));
+          } else if (attr->rta_type == IFA_LABEL) {
+            ifname = static_cast<const char*>(RTA_DATA(attr));
+          }
+        }
+
+        if (!m_filter(info->ifa_index, ifname)) {
+          continue;
+        }
+
+        if (msg->nlmsg_type == RTM_NEWADDR) {
+          m_ip = ip_buffer;
+        } else if (m_ip == ip_buffer) {
+          m_ip.clear();
+        }
+
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  // }}}
   // class : network {{{
 
   /**
    * Construct network interface
    */
-  network::network(string interface) : m_interface(interface) {
-    if (if_nametoindex(m_interface.c_str()) == 0)
+  network::network(string interface) : m_interface(interface), m_aggregate(is_interface_pattern(interface)) {
+    auto ifindex = if_nametoindex(m_interface.c_str());
+    if (ifindex == 0 && !m_aggregate)
       throw network_error("Invalid network interface \"" + m_interface + "\"");
     if ((m_socketfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
       throw network_error("Failed to open socket");
-    check_tuntap();
+
+    m_sampler = get_sampler();
+
+    if (m_aggregate) {
+      m_monitor = make_unique<link_monitor>([this](unsigned int, const char* ifname) {
+        return ifname != nullptr && fnmatch(m_interface.c_str(), ifname, 0) == 0;
+      });
+    } else {
+      // A recreated interface gets a new index, follow the index of
+      // the link using the configured name so that it keeps matching
+      m_monitor = make_unique<link_monitor>([this, ifindex](unsigned int index, const char* ifname) mutable {
+        if (ifname != nullptr && m_interface == ifname) {
+          ifindex = index;
+          return true;
+        }
+        return index == ifindex;
+      });
+      check_tuntap();
+    }
   }
 
   /**
@@ -58,55 +341,78 @@ namespace net {
   }
 
   /**
-   * Query device driver for information
+   * Read the transfer counters of the interface from the shared
+   * sampler, patterns and accumulate get the sum of all matching
+   * interfaces
    */
   bool network::query(bool accumulate) {
-    struct ifaddrs* ifaddr;
+    m_status.previous = m_status.current;
+    return m_sampler->read(accumulate ? "*" : m_interface, m_status.current);
+  }
+
+  /**
+   * Wait for link or address changes of the interface
+   *
+   * @return true if the interface changed
+   */
+  bool network::wait_for_change(int timeout_ms) {
+    return m_monitor->wait(timeout_ms);
+  }
+
+  /**
+   * Send ICMP echo requests to test internet connectivity
+   *
+   * Uses an unprivileged ICMP datagram socket and falls back
+   * to the ping command if those aren't allowed for our group
+   * (see net.ipv4.ping_group_range)
+   */
+  bool network::ping() const {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_ICMP);
+
+    if (fd == -1)
+      return ping_command();
+
+    auto handler = scope_util::make_exit_handler([&] { close(fd); });
 
-    if (getifaddrs(&ifaddr) == -1 || ifaddr == nullptr)
+    // Only allowed for unprivileged users since linux 5.7, the
+    // echo is sent through the default route if this fails
+    setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, m_interface.c_str(), m_interface.size());
+
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    if (inet_pton(AF_INET, CONNECTION_TEST_IP, &addr.sin_addr) != 1)
       return false;
 
-    m_status.previous = m_status.current;
-    m_status.current.transmitted = 0;
-    m_status.current.received = 0;
-    m_status.current.time = chrono::system_clock::now();
+    for (uint16_t sequence = 1; sequence <= 2; sequence++) {
+      // The kernel fills in the identifier and checksum
+      struct icmphdr request {};
+      request.type = ICMP_ECHO;
+      request.un.echo.sequence = htons(sequence);
 
-    for (auto ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-      if (ifa->ifa_addr == nullptr)
-        continue;
+      if (sendto(fd, &request, sizeof(request), 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1)
+        return false;
 
-      if (m_interface.compare(0, m_interface.length(), ifa->ifa_name) != 0)
-        if (!accumulate || (ifa->ifa_data == nullptr && ifa->ifa_addr->sa_family != AF_PACKET))
-          continue;
+      auto deadline = chrono::steady_clock::now() + chrono::seconds{2};
 
-      switch (ifa->ifa_addr->sa_family) {
-        case AF_INET:
-          char ip_buffer[NI_MAXHOST];
-          getnameinfo(ifa->ifa_addr, sizeof(sockaddr_in), ip_buffer, NI_MAXHOST, nullptr, 0, NI_NUMERICHOST);
-          m_status.ip = string{ip_buffer};
-          break;
+      while (true) {
+        auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
 
-        case AF_PACKET:
-          if (ifa->ifa_data == nullptr)
-            continue;
-          struct rtnl_link_stats* link_state = reinterpret_cast<decltype(link_state)>(ifa->ifa_data);
-          if (link_state == nullptr)
-            continue;
-          m_status.current.transmitted += link_state->tx_bytes;
-          m_status.current.received += link_state->rx_bytes;
+        if (remaining.count() <= 0 || !io_util::poll_read(fd, remaining.count()))
           break;
+
+        struct icmphdr reply {};
+        if (recv(fd, &reply, sizeof(reply), 0) >= static_cast<ssize_t>(sizeof(reply)) && reply.type == ICMP_ECHOREPLY)
+          return true;
       }
     }
 
-    freeifaddrs(ifaddr);
-
-    return true;
+    return false;
   }
 
   /**
    * Run ping command to test internet connectivity
    */
-  bool network::ping() const {
+  bool network::ping_command() const {
     try {
       auto exec = "ping -c 2 -W 2 -I " + m_interface + " " + string(CONNECTION_TEST_IP);
       auto ping = command_util::make_command(exec);
@@ -120,23 +426,48 @@ namespace net {
    * Get interface ip address
    */
   string network::ip() const {
-    return m_status.ip;
+    return m_monitor->ip();
   }
 
   /**
    * Get download speed rate
    */
   string network::downspeed(int minwidth) const {
-    float bytes_diff = m_status.current.received - m_status.previous.received;
-    return format_speedrate(bytes_diff, minwidth);
+    return format_speedrate(transferred().received, minwidth);
   }
 
   /**
    * Get upload speed rate
    */
   string network::upspeed(int minwidth) const {
-    float bytes_diff = m_status.current.transmitted - m_status.previous.transmitted;
-    return format_speedrate(bytes_diff, minwidth);
+    return format_speedrate(transferred().transmitted, minwidth);
+  }
+
+  /**
+   * Get the bytes transferred between the last two samples, summed
+   * over the interfaces present in both so that interfaces coming
+   * and going don't show up as spikes
+   */
+  link_counters network::transferred() const {
+    link_counters sum{};
+
+    for (auto&& current : m_status.current.interfaces) {
+      for (auto&& previous : m_status.previous.interfaces) {
+        if (previous.first != current.first) {
+          continue;
+        }
+        // Counters of a recreated interface start over
+        if (current.second.received >= previous.second.received) {
+          sum.received += current.second.received - previous.second.received;
+        }
+        if (current.second.transmitted >= previous.second.transmitted) {
+          sum.transmitted += current.second.transmitted - previous.second.transmitted;
+        }
+        break;
+      }
+    }
+
+    return sum;
   }
 
   /**
@@ -169,8 +500,32 @@ namespace net {
    * Test if the network interface is in a valid state
    */
   bool network::test_interface() const {
-    auto operstate = file_util::get_contents("/sys/class/net/" + m_interface + "/operstate");
-    return operstate.compare(0, 2, "up") == 0;
+    if (m_aggregate) {
+      for (auto&& ifname : m_sampler->interfaces(m_interface)) {
+        if (file_util::get_contents("/sys/class/net/" + ifname + "/operstate").compare(0, 2, "up") == 0)
+          return true;
+      }
+      return false;
+    }
+
+    auto path = "/sys/class/net/" + m_interface + "/operstate";
+
+    try {
+      // The attribute of a removed interface keeps failing, so
+      // reopen it once in case the interface has been recreated
+      for (int attempt = 0; attempt < 2; attempt++) {
+        if (!m_operstate)
+          m_operstate = make_unique<file_util::pread_reader>(path, 32);
+        auto contents = m_operstate->read();
+        if (contents != nullptr)
+          return strncmp(contents, "up", 2) == 0;
+        m_operstate.reset();
+      }
+    } catch (const system_error& err) {
+      m_operstate.reset();
+    }
+
+    return false;
   }
 
   /**
@@ -178,7 +533,7 @@ namespace net {
    */
   string network::format_speedrate(float bytes_diff, int minwidth) const {
     const auto duration = m_status.current.time - m_status.previous.time;
-    float time_diff = chrono::duration_cast<chrono::seconds>(duration).count();
+    float time_diff = chrono::duration_cast<chrono::duration<float>>(duration).count();
     float speedrate = bytes_diff / (time_diff ? time_diff : 1);
 
     vector<string> suffixes{"GB", "MB"};
@@ -204,6 +559,8 @@ namespace net {
       return true;
     else if (!network::query(accumulate))
       return false;
+    else if (m_aggregate)
+      return true;
 
     struct ifreq request;
     struct ethtool_cmd data;
@@ -212,8 +569,11 @@ namespace net {
     data.cmd = ETHTOOL_GSET;
     request.ifr_data = reinterpret_cast<caddr_t>(&data);
 
-    if (ioctl(m_socketfd, SIOCETHTOOL, &request) == -1)
-      return false;
+    if (ioctl(m_socketfd, SIOCETHTOOL, &request) == -1) {
+      // A removed interface is reported as disconnected instead
+      m_linkspeed = 0;
+      return if_nametoindex(m_interface.c_str()) == 0;
+    }
 
     m_linkspeed = data.speed;
 
@@ -226,6 +586,8 @@ namespace net {
   bool wired_network::connected() const {
     if (!m_tuntap && !network::test_interface())
       return false;
+    else if (m_aggregate)
+      return true;
 
     struct ethtool_value data;
     struct ifreq request;
@@ -266,8 +628,12 @@ namespace net {
 
     struct iwreq req;
 
-    if (iw_get_ext(socket_fd, m_interface.c_str(), SIOCGIWMODE, &req) == -1)
-      return false;
+    if (iw_get_ext(socket_fd, m_interface.c_str(), SIOCGIWMODE, &req) == -1) {
+      iw_sockets_close(socket_fd);
+      // A removed interface is reported as disconnected instead
+      m_essid.clear();
+      return if_nametoindex(m_interface.c_str()) == 0;
+    }
 
     // Ignore interfaces in ad-hoc mode
     if (req.u.mode == IW_MODE_ADHOC)
@@ -7,7 +7,9 @@
 #include "utils/bspwm.hpp"
 #include "utils/color.hpp"
 #include "utils/math.hpp"
+#include "utils/stats.hpp"
 #include "utils/string.hpp"
+#include "utils/trace.hpp"
 #include "x11/fonts.hpp"
 #include "x11/graphics.hpp"
 #include "x11/tray.hpp"
@@ -373,13 +375,16 @@ const bar_settings bar::settings() const {
  */
 void bar::parse(string data, bool force) {
   if (!m_mutex.try_lock()) {
+    stats_util::frames_skipped++;
     return;
   }
 
   std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
 
-  if (data == m_lastinput && !force)
+  if (data == m_lastinput && !force) {
+    stats_util::frames_skipped++;
     return;
+  }
 
   m_lastinput = data;
 
@@ -390,9 +395,12 @@ void bar::parse(string data, bool force) {
       m_renderer->reserve_space(edge::RIGHT, m_tray->settings().configured_w);
   }
 
+  trace_util::span span{"bar", "render"};
+
   m_renderer->begin();
 
   try {
+    trace_util::span span{"bar", "parse"};
     parser parser(m_opts);
     parser(data);
   } catch (const unrecognized_token& err) {
@@ -400,6 +408,8 @@ void bar::parse(string data, bool force) {
   }
 
   m_renderer->end();
+
+  stats_util::frames_rendered++;
 }
 
 /**
@@ -1,4 +1,5 @@
-#include <algorithm>
+#include <boost/property_tree/ini_parser.hpp>
+#include <map>
 
 #include "components/config.hpp"
 #include "utils/env.hpp"
@@ -10,23 +11,81 @@ POLYBAR_NS
  * Load configuration and validate bar section
  *
  * This is done outside the constructor due to boost::di noexcept
+ *
+ * The current values are left untouched if the file can't be
+ * parsed and are kept around to be able to tell what changed
  */
 void config::load(string file, string barname) {
-  m_file = file;
-  m_current_bar = barname;
-
   if (!file_util::exists(file))
     throw application_error("Could not find config file: " + file);
 
+  boost::property_tree::ptree tree;
+
   try {
-    boost::property_tree::read_ini(file, m_ptree);
+    boost::property_tree::read_ini(file, tree);
   } catch (const std::exception& e) {
     throw application_error(e.what());
   }
 
-  auto bars = defined_bars();
-  if (std::find(bars.begin(), bars.end(), m_current_bar) == bars.end())
-    throw application_error("Undefined bar: " + m_current_bar);
+  if (tree.find("bar/" + barname) == tree.not_found())
+    throw application_error("Undefined bar: " + barname);
+
+  // The new values are loaded into a separate table that replaces the
+  // current one once complete, readers keep using their own snapshot
+  auto table = make_shared<config_table>();
+  table->file = file;
+  table->bar = barname;
+
+  for (auto&& section : tree) {
+    auto& values = table->sections[section.first].values;
+    table->section_order.emplace_back(section.first);
+
+    for (auto&& param : section.second) {
+      values[param.first].raw = param.second.data();
+    }
+  }
+
+  for (auto&& section : table->sections) {
+    std::unordered_map<string, std::map<size_t, const config_value*>> lists;
+
+    for (auto&& param : section.second.values) {
+      auto& key = param.first;
+      auto& value = param.second;
+
+      try {
+        value.resolved = resolve(*table, section.first, key, value.raw);
+      } catch (const value_error& err) {
+        value.error = err.what();
+      }
+
+      // index list items, only canonical indices are used (key-0, key-1, ...)
+      auto pos = key.rfind('-');
+      if (pos == string::npos || pos == 0 || pos + 1 == key.size()) {
+        continue;
+      } else if (key.find_first_not_of("0123456789", pos + 1) != string::npos) {
+        continue;
+      } else if (key[pos + 1] == '0' && pos + 2 != key.size()) {
+        continue;
+      }
+
+      lists[key.substr(0, pos)].emplace(std::strtoul(key.c_str() + pos + 1, nullptr, 10), &value);
+    }
+
+    for (auto&& list : lists) {
+      auto& items = section.second.lists[list.first];
+      for (auto&& item : list.second) {
+        if (item.first != items.size())
+          break;
+        items.emplace_back(item.second);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(m_tablelock);
+    m_previous = move(m_table);
+    m_table = move(table);
+  }
 
   if (env_util::has("XDG_CONFIG_HOME"))
     file = string_util::replace(file, env_util::get("XDG_CONFIG_HOME"), "$XDG_CONFIG_HOME");
@@ -37,18 +96,26 @@ void config::load(string file, string barname) {
   m_logger.trace("config: Current bar section: [%s]", bar_section());
 }
 
+/**
+ * Load the current file again
+ */
+void config::reload() {
+  auto table = snapshot();
+  load(table->file, table->bar);
+}
+
 /**
  * Get path of loaded file
  */
 string config::filepath() const {
-  return m_file;
+  return snapshot()->file;
 }
 
 /**
  * Get the section name of the bar in use
  */
 string config::bar_section() const {
-  return "bar/" + m_current_bar;
+  return "bar/" + snapshot()->bar;
 }
 
 /**
@@ -57,9 +124,9 @@ string config::bar_section() const {
 vector<string> config::defined_bars() const {
   vector<string> bars;
 
-  for (auto&& p : m_ptree) {
-    if (p.first.compare(0, 4, "bar/") == 0)
-      bars.emplace_back(p.first.substr(4));
+  for (auto&& section : snapshot()->section_order) {
+    if (section.compare(0, 4, "bar/") == 0)
+      bars.emplace_back(section.substr(4));
   }
 
   return bars;
@@ -72,6 +139,92 @@ string config::build_path(const string& section, const string& key) const {
   return section + "." + key;
 }
 
+/**
+ * Get the keys of given section that were added, removed
+ * or changed value when the config was last loaded
+ */
+vector<string> config::changed_keys(const string& section) const {
+  shared_ptr<const config_table> current_table;
+  shared_ptr<const config_table> previous_table;
+  {
+    std::lock_guard<std::mutex> guard(m_tablelock);
+    current_table = m_table;
+    previous_table = m_previous;
+  }
+
+  vector<string> keys;
+  auto current = current_table->sections.find(section);
+  auto previous = previous_table->sections.find(section);
+
+  if (current != current_table->sections.end()) {
+    for (auto&& param : current->second.values) {
+      const config_value* old{nullptr};
+      if (previous != previous_table->sections.end()) {
+        auto it = previous->second.values.find(param.first);
+        old = it != previous->second.values.end() ? &it->second : nullptr;
+      }
+      if (old == nullptr || old->resolved != param.second.resolved || old->error != param.second.error)
+        keys.emplace_back(param.first);
+    }
+  }
+
+  if (previous != previous_table->sections.end()) {
+    for (auto&& param : previous->second.values) {
+      if (current == current_table->sections.end() || current->second.values.find(param.first) == current->second.values.end())
+        keys.emplace_back(param.first);
+    }
+  }
+
+  return keys;
+}
+
+/**
+ * Check if any parameter of given section changed when the config was last loaded
+ */
+bool config::changed(const string& section) const {
+  return !changed_keys(section).empty();
+}
+
+/**
+ * Get the currently loaded table, the returned
+ * table stays valid even if the config is reloaded
+ */
+shared_ptr<const config_table> config::snapshot() const {
+  std::lock_guard<std::mutex> guard(m_tablelock);
+  return m_table;
+}
+
+/**
+ * Find parameter in the given section
+ */
+const config_value* config::find(const config_table& table, const string& section, const string& key) const {
+  auto sect = table.sections.find(section);
+  if (sect == table.sections.end())
+    return nullptr;
+
+  auto value = sect->second.values.find(key);
+  if (value == sect->second.values.end())
+    return nullptr;
+
+  return &value->second;
+}
+
+/**
+ * Find list of parameters defined as key-0, key-1, ... in the given section
+ */
+const vector<const config_value*>* config::find_list(
+    const config_table& table, const string& section, const string& key) const {
+  auto sect = table.sections.find(section);
+  if (sect == table.sections.end())
+    return nullptr;
+
+  auto list = sect->second.lists.find(key);
+  if (list == sect->second.lists.end())
+    return nullptr;
+
+  return &list->second;
+}
+
 /**
  * Print a deprecation warning if the given parameter is set
  */
@@ -83,4 +236,115 @@ void config::warn_deprecated(string section, string key, string replacement) con
   }
 }
 
+/**
+ * Dereference the value references that can't be
+ * resolved when loading the config, i.e:
+ *  ${env:key}
+ *  ${xrdb:key}
+ */
+string config::dereference(const string& section, const string& key, const string& var) const {
+  if (var.compare(0, 2, "${") != 0 || var.back() != '}') {
+    return var;
+  }
+
+  auto path = var.substr(2, var.length() - 3);
+
+  if (path.compare(0, 4, "env:") == 0) {
+    return dereference_env(path.substr(4), var);
+  } else if (path.compare(0, 5, "xrdb:") == 0) {
+    return dereference_xrdb(path.substr(5));
+  } else {
+    throw value_error("Invalid reference defined at [" + build_path(section, key) + "]");
+  }
+}
+
+/**
+ * Resolve local value references defined using:
+ *  ${root.key}
+ *  ${self.key}
+ *  ${section.key}
+ *
+ * Other references are left for dereference() to handle
+ */
+string config::resolve(
+    const config_table& table, const string& section, const string& key, const string& var, size_t depth) const {
+  if (var.compare(0, 2, "${") != 0 || var.back() != '}') {
+    return var;
+  }
+
+  auto path = var.substr(2, var.length() - 3);
+  size_t pos;
+
+  if (path.compare(0, 4, "env:") == 0 || path.compare(0, 5, "xrdb:") == 0) {
+    return var;
+  } else if ((pos = path.find('.')) != string::npos) {
+    return dereference_local(table, path.substr(0, pos), path.substr(pos + 1), section, depth);
+  } else {
+    throw value_error("Invalid reference defined at [" + build_path(section, key) + "]");
+  }
+}
+
+/**
+ * Resolve local value reference
+ */
+string config::dereference_local(const config_table& table, string section, const string& key,
+    const string& current_section, size_t depth) const {
+  if (section == "BAR")
+    m_logger.warn("${BAR.key} is deprecated. Use ${root.key} instead");
+
+  section = string_util::replace(section, "BAR", "bar/" + table.bar, 0, 3);
+  section = string_util::replace(section, "root", "bar/" + table.bar, 0, 4);
+  section = string_util::replace(section, "self", current_section, 0, 4);
+
+  auto path = build_path(section, key);
+  auto value = find(table, section, key);
+
+  if (value == nullptr)
+    throw value_error("Unexisting reference defined [" + path + "]");
+  else if (depth >= 16)
+    throw value_error("Reference cycle detected at [" + path + "]");
+
+  return resolve(table, section, key, value->raw, depth + 1);
+}
+
+/**
+ * Dereference environment variable reference defined using:
+ *  ${env:key}
+ *  ${env:key:fallback value}
+ *
+ * If the variable isn't set and has no fallback
+ * the reference is used as is
+ */
+string config::dereference_env(string var, const string& raw) const {
+  size_t pos;
+  string fallback{raw};
+
+  if ((pos = var.find(':')) != string::npos) {
+    fallback = var.substr(pos + 1);
+    var.erase(pos);
+  }
+
+  if (env_util::has(var.c_str()))
+    return env_util::get(var.c_str());
+
+  return fallback;
+}
+
+/**
+ * Dereference X resource db value defined using:
+ *  ${xrdb:key}
+ *  ${xrdb:key:fallback value}
+ */
+string config::dereference_xrdb(string var) const {
+  size_t pos;
+  string fallback;
+
+  if ((pos = var.find(':')) != string::npos) {
+    fallback = var.substr(pos + 1);
+    var.erase(pos);
+  }
+
+  return m_xrm.get_string(var, fallback);
+}
+
 POLYBAR_NS_END
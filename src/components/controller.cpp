@@ -1,6 +1,8 @@
 #include <chrono>
 #include <csignal>
+#include <fstream>
 #include <mutex>
+#include <sstream>
 
 #include "components/bar.hpp"
 #include "components/config.hpp"
@@ -25,7 +27,9 @@
 #include "modules/xbacklight.hpp"
 #include "modules/xwindow.hpp"
 #include "utils/process.hpp"
+#include "utils/stats.hpp"
 #include "utils/string.hpp"
+#include "utils/trace.hpp"
 
 #if ENABLE_I3
 #include "modules/i3.hpp"
@@ -59,7 +63,7 @@ di::injector<unique_ptr<controller>> configure_controller(watch_t& confwatch) {
       di::bind<>().to(confwatch),
       configure_connection(),
       configure_logger(),
-      configure_config(),
+      configure_config<config&>(),
       configure_eventloop(),
       configure_bar());
   // clang-format on
@@ -81,6 +85,8 @@ controller::~controller() {
     m_log.info("Deconstructing eventloop");
     m_eventloop->set_update_cb(nullptr);
     m_eventloop->set_input_db(nullptr);
+
+    std::lock_guard<std::mutex> guard(m_modulelock);
     m_eventloop.reset();
   }
 
@@ -128,10 +134,17 @@ void controller::bootstrap(bool writeback, bool dump_wmname) {
     m_log.trace("controller: Create IPC handler");
     m_ipc = configure_ipc().create<decltype(m_ipc)>();
     m_ipc->attach_callback(bind(&controller::on_ipc_action, this, placeholders::_1));
+    m_ipc->attach_callback(bind(&controller::on_ipc_command, this, placeholders::_1));
+    m_ipc->attach_callback(ipc::query_callback{bind(&controller::on_ipc_query, this, placeholders::_1)});
   } else {
     m_log.info("Inter-process messaging disabled");
   }
 
+  if (m_conf.get<bool>("settings", "enable-tracing", false)) {
+    m_log.info("Recording trace events (send SIGUSR2 to dump)");
+    trace_util::enable();
+  }
+
   // Listen for events on the root window to be able to
   // break the blocking wait call when cleaning up
   m_log.trace("controller: Listen for events on the root window");
@@ -149,6 +162,7 @@ void controller::bootstrap(bool writeback, bool dump_wmname) {
 
   m_log.trace("controller: Attach eventloop update callback");
   m_eventloop->set_update_cb(bind(&controller::on_update, this));
+  m_eventloop->set_reload_cb(bind(&controller::on_reload, this));
 
   if (!m_writeback) {
     m_log.trace("controller: Attach eventloop input callback");
@@ -174,7 +188,7 @@ bool controller::run() {
 
   // Start ipc receiver if its enabled
   if (m_conf.get<bool>(m_conf.bar_section(), "enable-ipc", false)) {
-    m_threads.emplace_back(thread(&ipc::receive_messages, m_ipc.get()));
+    m_ipc->start();
   }
 
   // Listen for X events in separate thread
@@ -197,11 +211,11 @@ bool controller::run() {
     kill(getpid(), SIGTERM);
   }
 
+  m_running = false;
+
   uninstall_sigmask();
   uninstall_confwatch();
 
-  m_running = false;
-
   return !m_reload;
 }
 
@@ -216,6 +230,7 @@ void controller::install_sigmask() {
   sigaddset(&m_waitmask, SIGQUIT);
   sigaddset(&m_waitmask, SIGTERM);
   sigaddset(&m_waitmask, SIGUSR1);
+  sigaddset(&m_waitmask, SIGUSR2);
 
   if (pthread_sigmask(SIG_BLOCK, &m_waitmask, nullptr) == -1)
     throw system_error();
@@ -239,6 +254,11 @@ void controller::uninstall_sigmask() {
 
 /**
  * Listen for changes to the config file
+ *
+ * A single watcher thread is used for the lifetime of the
+ * controller, it re-adds the watch by path after each change
+ * since editors tend to replace the file by renaming another
+ * one over it instead of modifying it
  */
 void controller::install_confwatch() {
   if (!m_running)
@@ -250,27 +270,39 @@ void controller::install_confwatch() {
   }
 
   m_threads.emplace_back([this] {
-    this_thread::sleep_for(chrono::seconds{1});
-
     try {
-      if (!m_running)
-        return;
-
-      m_log.trace("controller: Attach config watch");
-      m_confwatch->attach(IN_MODIFY);
-
-      m_log.trace("controller: Wait for config file inotify event");
-      m_confwatch->get_event();
-
-      if (!m_running)
-        return;
-
-      m_log.info("Configuration file changed");
-      kill(getpid(), SIGUSR1);
+      while (m_running) {
+        m_log.trace("controller: Attach config watch");
+        try {
+          m_confwatch->attach(IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+        } catch (const system_error& err) {
+          // The file may be missing for a moment while it's being replaced
+          this_thread::sleep_for(chrono::milliseconds{500});
+          continue;
+        }
+
+        m_log.trace("controller: Wait for config file inotify event");
+        while (m_running && !m_confwatch->poll(500)) {
+        }
+
+        if (!m_running)
+          break;
+
+        m_confwatch->get_event();
+
+        m_log.info("Configuration file changed");
+        kill(getpid(), SIGUSR1);
+
+        // Drop the events fired while the file is still being written
+        for (int i = 0; m_running && i < 2; i++) {
+          if (m_confwatch->poll(500)) {
+            m_confwatch->get_event();
+          }
+        }
+      }
     } catch (const system_error& err) {
       m_log.err(err.what());
-      m_log.trace("controller: Reset config watch");
-      m_confwatch.reset();
+      m_log.trace("controller: Stop watching config");
     }
   });
 }
@@ -296,16 +328,31 @@ void controller::wait_for_signal() {
   m_waiting = true;
 
   int caught_signal = 0;
-  sigwait(&m_waitmask, &caught_signal);
 
-  m_log.warn("Termination signal received, shutting down...");
-  m_log.trace("controller: Caught signal %d", caught_signal);
+  // SIGUSR2 only requests a dump of the recorded trace events and
+  // SIGUSR1 a reload of the config, handled by the eventloop thread
+  while (sigwait(&m_waitmask, &caught_signal) == 0) {
+    if (caught_signal == SIGUSR2) {
+      dump_trace();
+    } else if (caught_signal != SIGUSR1 || !m_running) {
+      break;
+    } else if (!m_eventloop->enqueue(eventloop::entry_t{static_cast<int>(event_type::RELOAD)})) {
+      m_reload = true;
+      break;
+    }
+  }
+
+  if (m_reload) {
+    m_log.trace("controller: Caught signal %d, restarting...", caught_signal);
+  } else {
+    m_log.warn("Termination signal received, shutting down...");
+    m_log.trace("controller: Caught signal %d", caught_signal);
+  }
 
   if (m_eventloop) {
     m_eventloop->stop();
   }
 
-  m_reload = (caught_signal == SIGUSR1);
   m_waiting = false;
 }
 
@@ -343,91 +390,14 @@ void controller::wait_for_xevent() {
  * Create and initialize bar modules
  */
 void controller::bootstrap_modules() {
-  const bar_settings bar{m_bar->settings()};
-  string bs{m_conf.bar_section()};
   size_t module_count = 0;
 
   for (int i = 0; i < 3; i++) {
     alignment align = static_cast<alignment>(i + 1);
-    string confkey;
-
-    switch (align) {
-      case alignment::LEFT:
-        confkey = "modules-left";
-        break;
-      case alignment::CENTER:
-        confkey = "modules-center";
-        break;
-      case alignment::RIGHT:
-        confkey = "modules-right";
-        break;
-      default:
-        break;
-    }
-
-    for (auto& module_name : string_util::split(m_conf.get<string>(bs, confkey, ""), ' ')) {
-      if (module_name.empty()) {
-        continue;
-      }
 
+    for (auto& module_name : module_names(align)) {
       try {
-        auto type = m_conf.get<string>("module/" + module_name, "type");
-        module_t module;
-
-        if (type == "internal/counter")
-          module.reset(new counter_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/backlight")
-          module.reset(new backlight_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/battery")
-          module.reset(new battery_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/bspwm")
-          module.reset(new bspwm_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/cpu")
-          module.reset(new cpu_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/date")
-          module.reset(new date_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/fs")
-          module.reset(new fs_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/memory")
-          module.reset(new memory_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/i3")
-          module.reset(new i3_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/mpd")
-          module.reset(new mpd_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/volume")
-          module.reset(new volume_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/network")
-          module.reset(new network_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/temperature")
-          module.reset(new temperature_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/xbacklight")
-          module.reset(new xbacklight_module(bar, m_log, m_conf, module_name));
-        else if (type == "internal/xwindow")
-          module.reset(new xwindow_module(bar, m_log, m_conf, module_name));
-        else if (type == "custom/text")
-          module.reset(new text_module(bar, m_log, m_conf, module_name));
-        else if (type == "custom/script")
-          module.reset(new script_module(bar, m_log, m_conf, module_name));
-        else if (type == "custom/menu")
-          module.reset(new menu_module(bar, m_log, m_conf, module_name));
-        else if (type == "custom/ipc") {
-          if (!m_ipc)
-            throw application_error("Inter-process messaging needs to be enabled");
-          module.reset(new ipc_module(bar, m_log, m_conf, module_name));
-          m_ipc->attach_callback(
-              bind(&ipc_module::on_message, static_cast<ipc_module*>(module.get()), placeholders::_1));
-        } else
-          throw application_error("Unknown module: " + module_name);
-
-        module->set_update_cb(
-            bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<int>(event_type::UPDATE)}));
-        module->set_stop_cb(
-            bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<int>(event_type::CHECK)}));
-
-        module->setup();
-
-        m_eventloop->add_module(align, move(module));
-
+        m_eventloop->add_module(align, make_module(module_name));
         module_count++;
       } catch (const std::runtime_error& err) {
         m_log.err("Disabling module \"%s\" (error: %s)", module_name, err.what());
@@ -439,6 +409,101 @@ void controller::bootstrap_modules() {
     throw application_error("No modules created");
 }
 
+/**
+ * Get names of the modules configured for given alignment block
+ */
+vector<string> controller::module_names(alignment align) const {
+  string confkey;
+
+  switch (align) {
+    case alignment::LEFT:
+      confkey = "modules-left";
+      break;
+    case alignment::CENTER:
+      confkey = "modules-center";
+      break;
+    case alignment::RIGHT:
+      confkey = "modules-right";
+      break;
+    default:
+      return {};
+  }
+
+  vector<string> names;
+
+  for (auto& module_name : string_util::split(m_conf.get<string>(m_conf.bar_section(), confkey, ""), ' ')) {
+    if (!module_name.empty()) {
+      names.emplace_back(module_name);
+    }
+  }
+
+  return names;
+}
+
+/**
+ * Create and setup module of the configured type
+ */
+module_t controller::make_module(const string& module_name) const {
+  const bar_settings bar{m_bar->settings()};
+  auto type = m_conf.get<string>("module/" + module_name, "type");
+  module_t module;
+
+  if (type == "internal/counter")
+    module.reset(new counter_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/backlight")
+    module.reset(new backlight_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/battery")
+    module.reset(new battery_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/bspwm")
+    module.reset(new bspwm_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/cpu")
+    module.reset(new cpu_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/date")
+    module.reset(new date_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/fs")
+    module.reset(new fs_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/memory")
+    module.reset(new memory_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/i3")
+    module.reset(new i3_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/mpd")
+    module.reset(new mpd_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/volume")
+    module.reset(new volume_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/network")
+    module.reset(new network_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/temperature")
+    module.reset(new temperature_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/xbacklight")
+    module.reset(new xbacklight_module(bar, m_log, m_conf, module_name));
+  else if (type == "internal/xwindow")
+    module.reset(new xwindow_module(bar, m_log, m_conf, module_name));
+  else if (type == "custom/text")
+    module.reset(new text_module(bar, m_log, m_conf, module_name));
+  else if (type == "custom/script")
+    module.reset(new script_module(bar, m_log, m_conf, module_name));
+  else if (type == "custom/menu")
+    module.reset(new menu_module(bar, m_log, m_conf, module_name));
+  else if (type == "custom/ipc") {
+    if (!m_ipc)
+      throw application_error("Inter-process messaging needs to be enabled");
+    module.reset(new ipc_module(bar, m_log, m_conf, module_name));
+    m_ipc->attach_callback(bind(&ipc_module::on_message, static_cast<ipc_module*>(module.get()), placeholders::_1));
+    m_ipc->attach_callback(
+        ipc::set_callback{bind(&ipc_module::on_set, static_cast<ipc_module*>(module.get()), placeholders::_1)});
+  } else
+    throw application_error("Unknown module: " + module_name);
+
+  module->set_update_cb(
+      bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<int>(event_type::UPDATE)}));
+  module->set_stop_cb(
+      bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<int>(event_type::CHECK)}));
+
+  module->setup();
+
+  return module;
+}
+
 /**
  * Callback for received ipc actions
  */
@@ -457,6 +522,67 @@ void controller::on_ipc_action(const ipc_action& message) {
   m_eventloop->enqueue(evt);
 }
 
+/**
+ * Callback for received ipc commands
+ */
+void controller::on_ipc_command(const ipc_command& message) {
+  string command = message.payload.substr(strlen(ipc_command::prefix));
+  string argument;
+
+  // The command name is separated from its optional argument by a space
+  auto pos = command.find(' ');
+  if (pos != string::npos) {
+    argument = string_util::trim(command.substr(pos + 1), ' ');
+    command.erase(pos);
+  }
+
+  if (command == "stats") {
+    dump_stats(argument);
+  } else if (command == "trace-dump") {
+    dump_trace(argument);
+  } else if (!argument.empty()) {
+    throw application_error("Unexpected argument for command: " + command);
+  } else if (command == "trace-start") {
+    m_log.info("Started recording trace events");
+    trace_util::enable(true);
+  } else if (command == "trace-stop") {
+    m_log.info("Stopped recording trace events");
+    trace_util::enable(false);
+  } else {
+    throw application_error("Unrecognized command: " + command);
+  }
+}
+
+/**
+ * Callback for received ipc queries
+ *
+ * The answer is sent back to the client as a single line
+ */
+string controller::on_ipc_query(const ipc_query& message) {
+  string query = message.payload.substr(strlen(ipc_query::prefix));
+
+  if (query == "stats") {
+    std::ostringstream out;
+    write_stats(out);
+    return string_util::strip_trailing_newline(out.str());
+  } else if (query == "modules") {
+    vector<string> modules;
+    std::lock_guard<std::mutex> guard(m_modulelock);
+    if (m_eventloop) {
+      for (auto&& block : m_eventloop->modules()) {
+        for (auto&& module : block.second) {
+          modules.emplace_back(module->name() + (module->running() ? ":running" : ":stopped"));
+        }
+      }
+    }
+    return string_util::join(modules, " ");
+  } else if (query == "bar") {
+    return m_conf.bar_section();
+  }
+
+  throw application_error("Unrecognized query: " + query);
+}
+
 /**
  * Callback for clicked bar actions
  */
@@ -491,10 +617,181 @@ void controller::on_unrecognized_action(string input) {
   }
 }
 
+/**
+ * Write recorded trace events to given path,
+ * falling back to the compile time default
+ */
+void controller::dump_trace(string path) {
+  if (path.empty()) {
+    path = string_util::replace(PATH_TRACE_DUMP, "%pid%", to_string(getpid()));
+  }
+
+  try {
+    auto count = trace_util::dump(path);
+    m_log.info("Wrote %lu trace events to %s", count, path);
+  } catch (const system_error& err) {
+    m_log.err("Failed to dump trace events (%s)", err.what());
+  }
+}
+
+/**
+ * Write performance counters of the process and all
+ * modules to given path, falling back to the compile time default
+ */
+void controller::dump_stats(string path) {
+  if (path.empty()) {
+    path = string_util::replace(PATH_STATS_DUMP, "%pid%", to_string(getpid()));
+  }
+
+  std::ofstream out(path, std::ios::trunc);
+
+  if (!out) {
+    m_log.err("Failed to dump stats to %s", path);
+  } else {
+    write_stats(out);
+    m_log.info("Wrote stats to %s", path);
+  }
+}
+
+/**
+ * Callback for config reloads, called from the eventloop thread
+ *
+ * Only the modules whose section changed get recreated, the bar
+ * window, tray and all other modules are kept as they are. Changes
+ * to the bar (other than its module lists) or global settings still
+ * require the whole application to restart
+ */
+void controller::on_reload() {
+  m_log.info("Reloading configuration");
+
+  try {
+    m_conf.reload();
+  } catch (const application_error& err) {
+    m_log.err("Failed to reload config, keeping the current one (%s)", err.what());
+    return;
+  }
+
+  auto restart = [this](const string& reason) {
+    m_log.info("%s, restarting application...", reason);
+    m_reload = true;
+    m_eventloop->stop();
+  };
+
+  for (auto&& key : m_conf.changed_keys(m_conf.bar_section())) {
+    if (key != "modules-left" && key != "modules-center" && key != "modules-right") {
+      return restart("Bar settings changed");
+    }
+  }
+
+  if (m_conf.changed("settings")) {
+    return restart("Global settings changed");
+  }
+
+  // Amount of instances of each module in the new layout
+  map<string, size_t> wanted;
+  // Amount of running instances that can be kept as they are
+  map<string, size_t> kept;
+
+  for (int i = 0; i < 3; i++) {
+    for (auto&& module_name : module_names(static_cast<alignment>(i + 1))) {
+      wanted["module/" + module_name]++;
+    }
+  }
+
+  auto keep = [&](const string& name) {
+    if (m_conf.changed(name) || kept[name] >= wanted[name])
+      return false;
+    kept[name]++;
+    return true;
+  };
+
+  std::lock_guard<std::mutex> guard(m_modulelock);
+
+  // ipc modules attach callbacks to the ipc handler that can't be
+  // removed, so they can't be created or destroyed while running
+  for (auto&& block : m_eventloop->modules()) {
+    for (auto&& module : block.second) {
+      if (!keep(module->name()) && dynamic_cast<ipc_module*>(module.get()) != nullptr) {
+        return restart("IPC module " + module->name() + " changed");
+      }
+    }
+  }
+
+  for (auto&& module : wanted) {
+    if (kept[module.first] < module.second && m_conf.get<string>(module.first, "type", "") == "custom/ipc") {
+      return restart("IPC module " + module.first + " added");
+    }
+  }
+
+  map<string, vector<module_t>> running;
+  kept.clear();
+
+  for (auto&& block : m_eventloop->modules()) {
+    for (auto&& module : block.second) {
+      if (keep(module->name())) {
+        running[module->name()].emplace_back(move(module));
+      } else {
+        m_log.info("Removing %s", module->name());
+        module->stop();
+        module.reset();
+      }
+    }
+  }
+
+  m_eventloop->modules().clear();
+
+  for (int i = 0; i < 3; i++) {
+    alignment align = static_cast<alignment>(i + 1);
+
+    for (auto&& module_name : module_names(align)) {
+      auto& instances = running["module/" + module_name];
+
+      if (!instances.empty()) {
+        m_eventloop->add_module(align, move(instances.front()));
+        instances.erase(instances.begin());
+        continue;
+      }
+
+      try {
+        auto module = make_module(module_name);
+        m_log.info("Starting %s", module->name());
+        module->start();
+        m_eventloop->add_module(align, move(module));
+      } catch (const std::runtime_error& err) {
+        m_log.err("Disabling module \"%s\" (error: %s)", module_name, err.what());
+      }
+    }
+  }
+
+  on_update();
+}
+
+/**
+ * Write the performance counters of the process and all modules
+ *
+ * The module list is locked while writing since the
+ * counters belong to modules that a reload may destroy
+ */
+void controller::write_stats(std::ostream& out) {
+  vector<pair<string, const stats_util::module_counters*>> modules;
+  std::lock_guard<std::mutex> guard(m_modulelock);
+
+  if (m_eventloop) {
+    for (auto&& block : m_eventloop->modules()) {
+      for (auto&& module : block.second) {
+        modules.emplace_back(module->name(), &module->stats());
+      }
+    }
+  }
+
+  stats_util::write_json(out, modules);
+}
+
 /**
  * Callback for module content update
  */
 void controller::on_update() {
+  trace_util::span span{"controller", "on_update"};
   const bar_settings& bar{m_bar->settings()};
 
   string contents{""};
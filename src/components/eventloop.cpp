@@ -1,5 +1,6 @@
 #include "components/eventloop.hpp"
 #include "components/types.hpp"
+#include "utils/stats.hpp"
 #include "utils/string.hpp"
 #include "utils/time.hpp"
 #include "x11/color.hpp"
@@ -65,6 +66,7 @@ void eventloop::run(std::chrono::duration<double, std::milli> timeframe, int lim
           break;
         } else if (compare_events(evt, next)) {
           m_log.trace_x("eventloop: Swallowing event within timeframe");
+          stats_util::frames_skipped++;
           evt = next;
         } else {
           break;
@@ -108,6 +110,13 @@ void eventloop::set_input_db(callback<string>&& cb) {
   m_unrecognized_input_cb = forward<decltype(cb)>(cb);
 }
 
+/**
+ * Set callback handler for RELOAD events
+ */
+void eventloop::set_reload_cb(callback<>&& cb) {
+  m_reload_cb = forward<decltype(cb)>(cb);
+}
+
 /**
  * Add module to alignment block
  */
@@ -170,6 +179,8 @@ void eventloop::forward_event(entry_t evt) {
     on_input(string{evt.data});
   } else if (evt.type == static_cast<int>(event_type::CHECK)) {
     on_check();
+  } else if (evt.type == static_cast<int>(event_type::RELOAD)) {
+    on_reload();
   } else if (evt.type == static_cast<int>(event_type::QUIT)) {
     on_quit();
   } else {
@@ -232,6 +243,22 @@ void eventloop::on_check() {
   stop();
 }
 
+/**
+ * Handler for enqueued RELOAD events
+ *
+ * The callback runs on the loop thread, modules
+ * are replaced while holding the module list lock
+ */
+void eventloop::on_reload() {
+  m_log.trace("eventloop: Received RELOAD event");
+
+  if (m_reload_cb) {
+    m_reload_cb();
+  } else {
+    m_log.warn("No callback to handle reload");
+  }
+}
+
 /**
  * Handler for enqueued QUIT events
  */
@@ -1,30 +1,62 @@
 #include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include "components/ipc.hpp"
+#include "components/parser.hpp"
 #include "config.hpp"
-#include "utils/file.hpp"
-#include "utils/io.hpp"
 #include "utils/string.hpp"
 
 POLYBAR_NS
 
 /**
- * Interrupt the blocked listener and
- * remove the file handler
+ * Max size of a single message, clients sending
+ * longer lines get disconnected
+ */
+static constexpr size_t MAX_MESSAGE_SIZE{64 * 1024};
+
+/**
+ * Max size of the replies waiting to be sent to a
+ * client, clients that don't read them get disconnected
+ */
+static constexpr size_t MAX_OUTPUT_SIZE{1024 * 1024};
+
+/**
+ * Construct ipc handler
+ */
+ipc::ipc(const logger& logger) : m_log(logger) {
+  if ((m_wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+    m_log.err("Failed to create ipc wakeup handle (%s)", strerror(errno));
+  }
+}
+
+/**
+ * Interrupt the listener and wait for
+ * it to close the messaging channels
  */
 ipc::~ipc() {
   m_running = false;
 
-  if (!m_fifo.empty()) {
+  if (m_wakefd != -1) {
     m_log.info("Interrupting ipc message receiver");
 
-    auto f = make_unique<file_util::file_ptr>(m_fifo);
-    char p[1]{'q'};
+    uint64_t value{1};
+    if (::write(m_wakefd, &value, sizeof(value)) == -1) {
+      m_log.err("Failed to interrupt ipc message receiver");
+    }
+  }
 
-    fwrite(p, sizeof(char), sizeof(p), (*f)());
-    unlink(m_fifo.c_str());
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+  if (m_wakefd != -1) {
+    close(m_wakefd);
+    m_wakefd = -1;
   }
 }
 
@@ -50,70 +82,424 @@ void ipc::attach_callback(callback<const ipc_action&>&& cb) {
 }
 
 /**
- * Start listening for event messages
+ * Register listener callback for ipc_set messages
  */
-void ipc::receive_messages() {
+void ipc::attach_callback(set_callback&& cb) {
+  m_set_callbacks.emplace_back(cb);
+}
+
+/**
+ * Register the handler answering ipc_query messages
+ */
+void ipc::attach_callback(query_callback&& cb) {
+  m_query_callback = forward<decltype(cb)>(cb);
+}
+
+/**
+ * Start listening for event messages in a separate
+ * thread that is joined when the handler gets destroyed
+ */
+void ipc::start() {
+  if (m_wakefd == -1 || m_thread.joinable()) {
+    return;
+  }
+
   m_running = true;
+  m_thread = thread(&ipc::receive_messages, this);
+}
+
+/**
+ * Receive and handle messages until interrupted
+ */
+void ipc::receive_messages() {
+  try {
+    listen();
+  } catch (const system_error& err) {
+    m_log.err("Failed to setup messaging channels (%s)", err.what());
+    cleanup();
+    return;
+  }
+
+  epoll_event events[16];
+
+  while (m_running) {
+    int count = epoll_wait(m_epollfd, events, sizeof(events) / sizeof(events[0]), -1);
+
+    if (count == -1 && errno == EINTR) {
+      continue;
+    } else if (count == -1) {
+      m_log.err("Failed to wait for ipc messages (%s)", strerror(errno));
+      break;
+    }
+
+    for (int i = 0; i < count && m_running; i++) {
+      int fd = events[i].data.fd;
+
+      if (fd == m_wakefd) {
+        m_running = false;
+      } else if (fd == m_listenfd) {
+        accept_clients();
+      } else if (fd == m_fifofd) {
+        if (!receive(m_fifofd, m_fifo_buffer, nullptr)) {
+          m_log.err("Failed to read from messaging fifo, closing it (%s)", strerror(errno));
+          epoll_ctl(m_epollfd, EPOLL_CTL_DEL, m_fifofd, nullptr);
+          close(m_fifofd);
+          unlink(m_fifo.c_str());
+          m_fifofd = -1;
+        }
+      } else if (m_clients.find(fd) != m_clients.end()) {
+        handle_client(fd, events[i].events);
+      }
+    }
+  }
+
+  cleanup();
+}
+
+/**
+ * Create the fifo and the unix socket and
+ * register them with the epoll instance
+ */
+void ipc::listen() {
   m_fifo = string_util::replace(PATH_MESSAGING_FIFO, "%pid%", to_string(getpid()));
+  m_socket = string_util::replace(PATH_MESSAGING_SOCKET, "%pid%", to_string(getpid()));
+
+  if ((m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    throw system_error("Failed to create epoll instance");
+  }
+
+  epoll_event evt{};
+  evt.events = EPOLLIN;
+
+  evt.data.fd = m_wakefd;
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_wakefd, &evt) == -1) {
+    throw system_error("Failed to watch wakeup handle");
+  }
+
+  // The fifo is opened for writing as well so that it
+  // stays open when the writers close their end
+  if (mkfifo(m_fifo.c_str(), 0666) == -1 && errno != EEXIST) {
+    m_log.err("Failed to create messaging fifo %s (%s)", m_fifo, strerror(errno));
+  } else if ((m_fifofd = open(m_fifo.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC)) == -1) {
+    m_log.err("Failed to open messaging fifo %s (%s)", m_fifo, strerror(errno));
+  } else {
+    evt.data.fd = m_fifofd;
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_fifofd, &evt) == -1) {
+      throw system_error("Failed to watch messaging fifo");
+    }
+    m_log.info("Listening for ipc messages on: %s", m_fifo);
+  }
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+
+  if (m_socket.size() >= sizeof(addr.sun_path)) {
+    throw system_error("Socket path too long: " + m_socket);
+  }
+
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", m_socket.c_str());
+  unlink(m_socket.c_str());
+
+  if ((m_listenfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+    throw system_error("Failed to create messaging socket");
+  } else if (bind(m_listenfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    throw system_error("Failed to bind messaging socket " + m_socket);
+  } else if (::listen(m_listenfd, 16) == -1) {
+    throw system_error("Failed to listen on messaging socket");
+  }
+
+  evt.data.fd = m_listenfd;
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_listenfd, &evt) == -1) {
+    throw system_error("Failed to watch messaging socket");
+  }
+
+  m_log.info("Listening for ipc messages on: %s", m_socket);
+}
+
+/**
+ * Accept pending client connections
+ */
+void ipc::accept_clients() {
+  int fd;
+
+  while ((fd = accept4(m_listenfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+    epoll_event evt{};
+    evt.events = EPOLLIN | EPOLLRDHUP;
+    evt.data.fd = fd;
+
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &evt) == -1) {
+      m_log.err("Failed to watch ipc client (%s)", strerror(errno));
+      close(fd);
+    } else {
+      m_log.trace("ipc: Client connected (fd=%i)", fd);
+      m_clients[fd].events = evt.events;
+    }
+  }
+
+  if (errno != EAGAIN && errno != EWOULDBLOCK) {
+    m_log.err("Failed to accept ipc client (%s)", strerror(errno));
+  }
+}
+
+/**
+ * Handle the messages of a client and send the pending replies,
+ * a client that closed its end is disconnected once all of
+ * its replies have been sent
+ */
+void ipc::handle_client(int fd, uint32_t events) {
+  auto& conn = m_clients[fd];
+
+  if (!conn.closing && events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+    conn.closing = !receive(fd, conn.input, &conn.output);
+  }
+
+  if (!flush(fd, conn) || (conn.closing && conn.output.empty())) {
+    disconnect(fd);
+  }
+}
+
+/**
+ * Read all available data from given fd and handle
+ * each complete message, the trailing partial message
+ * is kept in the buffer until the rest of it arrives
+ *
+ * The replies are appended to the given output buffer,
+ * messages read from the fifo aren't answered
+ *
+ * @return false if the connection should be closed
+ */
+bool ipc::receive(int fd, string& buffer, string* replies) {
+  char data[BUFSIZ];
+  ssize_t bytes;
+
+  while ((bytes = ::read(fd, data, sizeof(data))) != 0) {
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes == -1) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    buffer.append(data, bytes);
+
+    size_t start{0};
+    size_t end;
+
+    while ((end = buffer.find('\n', start)) != string::npos) {
+      auto message = string_util::strip(buffer.substr(start, end - start), '\r');
+      start = end + 1;
+
+      if (message.empty()) {
+        continue;
+      }
+
+      auto result = parse(message);
 
-  if (mkfifo(m_fifo.c_str(), 0666) == -1) {
-    m_log.err("Failed to create messaging channel");
+      if (replies != nullptr) {
+        *replies += result + "\n";
+      }
+    }
+
+    buffer.erase(0, start);
+
+    // Check the limit for each chunk so that a client that keeps
+    // writing without a newline can't grow the buffer unbounded
+    if (buffer.size() > MAX_MESSAGE_SIZE) {
+      m_log.warn("ipc: Message exceeds %lu bytes, discarding it (fd=%i)", MAX_MESSAGE_SIZE, fd);
+      buffer.clear();
+
+      if (replies != nullptr) {
+        return false;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Send as much of the pending replies as the socket accepts
+ * and only watch for it to become writable while some are left
+ *
+ * @return false if the connection should be closed
+ */
+bool ipc::flush(int fd, client& conn) {
+  while (!conn.output.empty()) {
+    auto bytes = send(fd, conn.output.c_str(), conn.output.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else if (bytes == -1) {
+      m_log.warn("ipc: Failed to send reply, closing connection (fd=%i, error=%s)", fd, strerror(errno));
+      return false;
+    }
+
+    conn.output.erase(0, bytes);
   }
 
-  m_log.info("Listening for ipc messages on: %s", m_fifo);
+  if (conn.output.size() > MAX_OUTPUT_SIZE) {
+    m_log.warn("ipc: Client isn't reading its replies, closing connection (fd=%i)", fd);
+    return false;
+  }
 
-  while ((m_fd = open(m_fifo.c_str(), O_RDONLY)) != -1 && m_running) {
-    parse(io_util::readline(m_fd));
-    close(m_fd);
+  uint32_t events{0};
+  if (!conn.closing) {
+    events |= EPOLLIN | EPOLLRDHUP;
   }
+  if (!conn.output.empty()) {
+    events |= EPOLLOUT;
+  }
+
+  if (events != conn.events) {
+    epoll_event evt{};
+    evt.events = events;
+    evt.data.fd = fd;
+
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_MOD, fd, &evt) == -1) {
+      m_log.err("Failed to watch ipc client (%s)", strerror(errno));
+      return false;
+    }
+
+    conn.events = events;
+  }
+
+  return true;
+}
+
+/**
+ * Close client connection
+ */
+void ipc::disconnect(int fd) {
+  m_log.trace("ipc: Client disconnected (fd=%i)", fd);
+  epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  m_clients.erase(fd);
+}
+
+/**
+ * Close all connections and remove the messaging channels
+ */
+void ipc::cleanup() {
+  while (!m_clients.empty()) {
+    disconnect(m_clients.begin()->first);
+  }
+
+  if (m_listenfd != -1) {
+    close(m_listenfd);
+    unlink(m_socket.c_str());
+    m_listenfd = -1;
+  }
+
+  if (m_fifofd != -1) {
+    close(m_fifofd);
+    unlink(m_fifo.c_str());
+    m_fifofd = -1;
+  }
+
+  if (m_epollfd != -1) {
+    close(m_epollfd);
+    m_epollfd = -1;
+  }
+
+  m_running = false;
 }
 
 /**
  * Process received message and delegate
  * valid events to the target modules
+ *
+ * @return Reply for the sender of the message
  */
-void ipc::parse(const string& payload) const {
-  if (payload.empty()) {
-    return;
-  } else if (payload.find(ipc_command::prefix) == 0) {
-    delegate(ipc_command{payload});
-  } else if (payload.find(ipc_hook::prefix) == 0) {
-    delegate(ipc_hook{payload});
-  } else if (payload.find(ipc_action::prefix) == 0) {
-    delegate(ipc_action{payload});
-  } else {
-    m_log.warn("Received unknown ipc message: (payload=%s)", payload);
+string ipc::parse(const string& payload) const {
+  bool handled{false};
+
+  try {
+    if (payload.find(ipc_command::prefix) == 0) {
+      handled = delegate(ipc_command{payload});
+    } else if (payload.find(ipc_hook::prefix) == 0) {
+      handled = delegate(ipc_hook{payload});
+    } else if (payload.find(ipc_action::prefix) == 0) {
+      handled = delegate(ipc_action{payload});
+    } else if (payload.find(ipc_set::prefix) == 0) {
+      if (!delegate(ipc_set{payload}))
+        return "error Unknown module";
+      return "ok";
+    } else if (payload.find(ipc_query::prefix) == 0) {
+      auto result = delegate(ipc_query{payload});
+      return result.empty() ? "ok" : "ok " + result;
+    } else {
+      m_log.warn("Received unknown ipc message: (payload=%s)", payload);
+      return "error Unknown message type";
+    }
+  } catch (const std::exception& err) {
+    m_log.err("Failed to handle ipc message (payload=%s, error=%s)", payload, err.what());
+    return "error " + string{err.what()};
   }
+
+  return handled ? "ok" : "error Unhandled message";
 }
 
 /**
  * Send ipc message to attached listeners
  */
-void ipc::delegate(const ipc_command& message) const {
+bool ipc::delegate(const ipc_command& message) const {
   if (!m_command_callbacks.empty())
     for (auto&& callback : m_command_callbacks) callback(message);
   else
     m_log.warn("Unhandled message (payload=%s)", message.payload);
+  return !m_command_callbacks.empty();
 }
 
 /**
  * Send ipc message to attached listeners
  */
-void ipc::delegate(const ipc_hook& message) const {
+bool ipc::delegate(const ipc_hook& message) const {
   if (!m_hook_callbacks.empty())
     for (auto&& callback : m_hook_callbacks) callback(message);
   else
     m_log.warn("Unhandled message (payload=%s)", message.payload);
+  return !m_hook_callbacks.empty();
 }
 
 /**
  * Send ipc message to attached listeners
  */
-void ipc::delegate(const ipc_action& message) const {
+bool ipc::delegate(const ipc_action& message) const {
   if (!m_action_callbacks.empty())
     for (auto&& callback : m_action_callbacks) callback(message);
   else
     m_log.warn("Unhandled message (payload=%s)", message.payload);
+  return !m_action_callbacks.empty();
+}
+
+/**
+ * Validate the pushed content and send it to the
+ * attached listeners until one of them accepts it
+ */
+bool ipc::delegate(const ipc_set& message) const {
+  auto pos = message.payload.find(':', strlen(ipc_set::prefix));
+
+  if (pos == string::npos)
+    throw application_error("Expected set:<module>:<content>");
+
+  parser::validate(message.payload.substr(pos + 1));
+
+  for (auto&& callback : m_set_callbacks) {
+    if (callback(message))
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * Get the answer to given query
+ */
+string ipc::delegate(const ipc_query& message) const {
+  if (!m_query_callback)
+    throw application_error("Unhandled message");
+  return m_query_callback(message);
 }
 
 POLYBAR_NS_END
@@ -1,3 +1,4 @@
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "components/logger.hpp"
@@ -6,21 +7,49 @@
 POLYBAR_NS
 
 /**
- * Construct logger
+ * Amount of messages the queue can hold before
+ * low priority messages start getting dropped
  */
-logger::logger(loglevel level) : m_level(level) {
+static constexpr size_t LOG_QUEUE_SIZE{1024};
+
+/**
+ * Construct logger and start the writer thread
+ */
+logger::logger(loglevel level) : m_level(level), m_queue(LOG_QUEUE_SIZE) {
   if (isatty(m_fd)) {
     // clang-format off
-    m_prefixes[loglevel::TRACE]   = "\r\033[0;90m- ";
-    m_prefixes[loglevel::INFO]    = "\r\033[1;32m* \033[0m";
-    m_prefixes[loglevel::WARNING] = "\r\033[1;33mwarn: \033[0m";
-    m_prefixes[loglevel::ERROR]   = "\r\033[1;31merror: \033[0m";
-    m_suffixes[loglevel::TRACE]   = "\033[0m";
-    m_suffixes[loglevel::INFO]    = "\033[0m";
-    m_suffixes[loglevel::WARNING] = "\033[0m";
-    m_suffixes[loglevel::ERROR]   = "\033[0m";
+    m_prefixes[static_cast<size_t>(loglevel::TRACE)]   = "\r\033[0;90m- ";
+    m_prefixes[static_cast<size_t>(loglevel::INFO)]    = "\r\033[1;32m* \033[0m";
+    m_prefixes[static_cast<size_t>(loglevel::WARNING)] = "\r\033[1;33mwarn: \033[0m";
+    m_prefixes[static_cast<size_t>(loglevel::ERROR)]   = "\r\033[1;31merror: \033[0m";
+    m_suffixes[static_cast<size_t>(loglevel::TRACE)]   = "\033[0m\n";
+    m_suffixes[static_cast<size_t>(loglevel::INFO)]    = "\033[0m\n";
+    m_suffixes[static_cast<size_t>(loglevel::WARNING)] = "\033[0m\n";
+    m_suffixes[static_cast<size_t>(loglevel::ERROR)]   = "\033[0m\n";
     // clang-format on
   }
+
+  m_running = true;
+  m_writer = thread(&logger::writer, this);
+}
+
+/**
+ * Stop the writer thread and flush pending messages
+ */
+logger::~logger() {
+  m_running = false;
+  m_queue.enqueue(log_entry{});
+
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+
+  log_entry entry;
+  while (m_queue.try_dequeue(entry)) {
+    process(move(entry));
+  }
+
+  flush_repeated();
 }
 
 /**
@@ -41,6 +70,95 @@ void logger::verbosity(string level) {
   verbosity(parse_loglevel_name(level));
 }
 
+/**
+ * Queue formatted message for the writer thread
+ *
+ * The enqueue attempt will not allocate memory, so once the
+ * queue is full info and trace messages are dropped instead
+ * of blocking or growing the queue. Errors and warnings
+ * are always queued.
+ */
+void logger::write(loglevel level, string&& message) const {
+  log_entry entry{level, forward<string>(message)};
+
+  // The entry is only moved from if there was room for it
+  if (m_queue.try_enqueue(move(entry))) {
+    return;
+  } else if (level <= loglevel::WARNING) {
+    m_queue.enqueue(move(entry));
+  } else {
+    m_dropped++;
+  }
+}
+
+/**
+ * Write queued messages to the output channel
+ */
+void logger::writer() {
+  log_entry entry;
+
+  while (m_running) {
+    if (!m_queue.wait_dequeue_timed(entry, std::chrono::seconds{1})) {
+      flush_repeated();
+    } else if (entry.level != loglevel::NONE) {
+      process(move(entry));
+    }
+  }
+}
+
+/**
+ * Write message unless it's identical to the previous one,
+ * in which case it only gets counted
+ */
+void logger::process(log_entry&& entry) {
+  if (entry.level == loglevel::NONE) {
+    return;
+  } else if (entry.level == m_last.level && entry.message == m_last.message) {
+    m_repeated++;
+    return;
+  }
+
+  flush_repeated();
+
+  size_t dropped{m_dropped.exchange(0)};
+  if (dropped > 0) {
+    flush({loglevel::WARNING, "logger: Dropped " + to_string(dropped) + " messages (queue full)"});
+  }
+
+  flush(entry);
+  m_last = forward<log_entry>(entry);
+}
+
+/**
+ * Write message to the output channel using a single syscall
+ */
+void logger::flush(const log_entry& entry) const {
+  const auto& prefix = m_prefixes[static_cast<size_t>(entry.level)];
+  const auto& suffix = m_suffixes[static_cast<size_t>(entry.level)];
+
+  struct iovec iov[3];
+  iov[0].iov_base = const_cast<char*>(prefix.data());
+  iov[0].iov_len = prefix.size();
+  iov[1].iov_base = const_cast<char*>(entry.message.data());
+  iov[1].iov_len = entry.message.size();
+  iov[2].iov_base = const_cast<char*>(suffix.data());
+  iov[2].iov_len = suffix.size();
+
+  writev(m_fd, iov, 3);
+}
+
+/**
+ * Write summary of the collapsed repetitions of the last message
+ */
+void logger::flush_repeated() {
+  if (m_repeated == 0) {
+    return;
+  }
+
+  flush({m_last.level, "Last message repeated " + to_string(m_repeated) + " times"});
+  m_repeated = 0;
+}
+
 /**
  * Convert given loglevel name to its enum type counterpart
  */
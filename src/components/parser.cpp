@@ -26,6 +26,36 @@ void parser::operator()(string data) {
   }
 }
 
+/**
+ * Check that the data only contains complete tag blocks
+ * that can be used as module contents, i.e. no alignment tags
+ *
+ * @throws unrecognized_token
+ */
+void parser::validate(const string& data) {
+  size_t start{0};
+  size_t end;
+
+  while ((start = data.find("%{", start)) != string::npos) {
+    if ((end = data.find('}', start)) == string::npos)
+      throw unrecognized_token("Unclosed tag block");
+
+    auto block = data.substr(start + 2, end - start - 2);
+    start = end + 1;
+
+    for (auto&& token : string_util::split(block, ' ')) {
+      if (token.empty())
+        continue;
+      else if (token[0] == 'A')
+        break;
+      else if (token[0] == 'l' || token[0] == 'c' || token[0] == 'r')
+        throw unrecognized_token("Alignment tags are not allowed");
+      else if (string{"BFURTO+-"}.find(token[0]) == string::npos)
+        throw unrecognized_token(string{token[0]});
+    }
+  }
+}
+
 /**
  * Parse contents in tag blocks, i.e: %{...}
  */
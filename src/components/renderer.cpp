@@ -1,5 +1,7 @@
 #include "components/renderer.hpp"
 #include "components/logger.hpp"
+#include "utils/stats.hpp"
+#include "utils/trace.hpp"
 #include "x11/connection.hpp"
 #include "x11/draw.hpp"
 #include "x11/fonts.hpp"
@@ -169,8 +171,16 @@ void renderer::redraw() {
 
   fill_border(m_bar.borders, edge::ALL);
 
-  m_connection.copy_area(
-      m_pixmap, m_window, m_gcontexts.at(gc::FG), rect.x, rect.y, rect.x, rect.y, rect.width, rect.height);
+  // The sequence number of the last request of the frame tells how many
+  // requests have been issued on the shared connection since the last one
+  auto sequence = xcb_copy_area(m_connection, m_pixmap, m_window, m_gcontexts.at(gc::FG), rect.x, rect.y, rect.x,
+      rect.y, rect.width, rect.height).sequence;
+  if (m_sequence != 0) {
+    stats_util::x_connection_requests += sequence - m_sequence;
+  }
+  m_sequence = sequence;
+
+  trace_util::span span{"renderer", "flush"};
   m_connection.flush();
 }
 
@@ -9,55 +9,44 @@
 #include "utils/math.hpp"
 
 #include "modules/meta/base.inl"
-#include "modules/meta/inotify_module.inl"
+#include "modules/meta/event_module.inl"
 
 POLYBAR_NS
 
 namespace modules {
   template class module<battery_module>;
-  template class inotify_module<battery_module>;
+  template class event_module<battery_module>;
 
   /**
    * Bootstrap module by setting up required components
    */
   void battery_module::setup() {
-    auto battery = m_conf.get<string>(name(), "battery", "BAT0");
-    auto adapter = m_conf.get<string>(name(), "adapter", "ADP1");
-
-    auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", adapter) + "/";
-    auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", battery) + "/";
-
-    if (!file_util::exists(path_adapter + "online"))
-      throw module_error("The file '" + path_adapter + "online' does not exist");
-    m_valuepath[battery_value::ADAPTER] = path_adapter + "online";
-
-    if (!file_util::exists(path_battery + "capacity"))
-      throw module_error("The file '" + path_battery + "capacity' does not exist");
-    m_valuepath[battery_value::CAPACITY_PERC] = path_battery + "capacity";
-
-    if (!file_util::exists(path_battery + "voltage_now"))
-      throw module_error("The file '" + path_battery + "voltage_now' does not exist");
-    m_valuepath[battery_value::VOLTAGE] = path_battery + "voltage_now";
-
-    for (auto&& file : vector<string>{"charge", "energy"}) {
-      if (file_util::exists(path_battery + file + "_now"))
-        m_valuepath[battery_value::CAPACITY] = path_battery + file + "_now";
-      if (file_util::exists(path_battery + file + "_full"))
-        m_valuepath[battery_value::CAPACITY_MAX] = path_battery + file + "_full";
-    }
-
-    if (m_valuepath[battery_value::CAPACITY].empty())
-      throw module_error("The file '" + path_battery + "[charge|energy]_now' does not exist");
-    if (m_valuepath[battery_value::CAPACITY_MAX].empty())
-      throw module_error("The file '" + path_battery + "[charge|energy]_full' does not exist");
-
-    for (auto&& file : vector<string>{"current", "power"}) {
-      if (file_util::exists(path_battery + file + "_now"))
-        m_valuepath[battery_value::RATE] = path_battery + file + "_now";
-    }
+    m_battery = m_conf.get<string>(name(), "battery", "BAT0");
+    m_adapter = m_conf.get<string>(name(), "adapter", "ADP1");
+
+    auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", m_adapter) + "/";
+    auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", m_battery) + "/";
+
+    // Keep the value files open so that they can be re-read using pread
+    auto open_value = [&](battery_value value, const string& path, const vector<string>& candidates,
+                          const string& suffix) {
+      for (auto&& file : candidates) {
+        if (file_util::exists(path + file + suffix)) {
+          m_values[value] = make_unique<file_util::pread_reader>(path + file + suffix, 64);
+        }
+      }
+      if (!m_values[value]) {
+        auto files = candidates.size() > 1 ? "[" + string_util::join(candidates, "|") + "]" : candidates[0];
+        throw module_error("The file '" + path + files + suffix + "' does not exist");
+      }
+    };
 
-    if (m_valuepath[battery_value::RATE].empty())
-      throw module_error("The file '" + path_battery + "[current|power]_now' does not exist");
+    open_value(battery_value::ADAPTER, path_adapter, {"online"}, "");
+    open_value(battery_value::CAPACITY_PERC, path_battery, {"capacity"}, "");
+    open_value(battery_value::VOLTAGE, path_battery, {"voltage_now"}, "");
+    open_value(battery_value::CAPACITY, path_battery, {"charge", "energy"}, "_now");
+    open_value(battery_value::CAPACITY_MAX, path_battery, {"charge", "energy"}, "_full");
+    open_value(battery_value::RATE, path_battery, {"current", "power"}, "_now");
 
     m_fullat = m_conf.get<int>(name(), "full-at", 100);
     m_interval = chrono::duration<double>{m_conf.get<float>(name(), "poll-interval", 5.0f)};
@@ -87,15 +76,23 @@ namespace modules {
     if (m_formatter->has(TAG_LABEL_FULL, FORMAT_FULL))
       m_label_full = load_optional_label(m_conf, name(), TAG_LABEL_FULL, "%percentage%");
 
-    // Create inotify watches
-    watch(m_valuepath[battery_value::CAPACITY_PERC], IN_ACCESS);
-    watch(m_valuepath[battery_value::ADAPTER], IN_ACCESS);
+    // Listen for power supply uevents, falling back
+    // to plain polling if the socket can't be opened
+    try {
+      m_uevent = make_unique<uevent_util::monitor>("power_supply");
+    } catch (const system_error& err) {
+      m_log.warn("%s: Failed to listen for uevents, relying on polling (%s)", name(), err.what());
+      if (m_interval.count() <= 0) {
+        m_interval = chrono::duration<double>{5.0};
+      }
+    }
 
     // Setup time if token is used
     if (m_label_charging->has_token("%time%") || m_label_discharging->has_token("%time%")) {
       if (!m_bar.locale.empty())
         setlocale(LC_TIME, m_bar.locale.c_str());
       m_timeformat = m_conf.get<string>(name(), "time-format", "%H:%M:%S");
+      m_rate = math_util::moving_average<long>{m_conf.get<size_t>(name(), "time-samples", 12)};
     }
   }
 
@@ -104,7 +101,7 @@ namespace modules {
    * charging animation when the module is started
    */
   void battery_module::start() {
-    inotify_module::start();
+    event_module::start();
     m_threads.emplace_back(thread(&battery_module::subthread, this));
   }
 
@@ -116,36 +113,60 @@ namespace modules {
   }
 
   /**
-   * Idle between polling inotify watches for events.
-   *
-   * If the defined interval has been reached, trigger a manual
-   * poll in case the inotify events aren't fired.
+   * Wait for uevents until the poll interval is reached.
    *
-   * This fallback is needed because some systems won't
-   * report inotify events for files on sysfs.
+   * The socket is polled in short slices so that
+   * the module can be stopped without delay.
    */
   void battery_module::idle() {
-    if (m_interval.count() > 0) {
-      auto now = chrono::system_clock::now();
+    auto timeout = chrono::milliseconds{250};
 
-      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
-        m_lastpoll = now;
-        m_log.info("%s: Polling values (inotify fallback)", name());
-        file_util::get_contents(m_valuepath[battery_value::CAPACITY_PERC]);
-      }
+    if (m_interval.count() > 0) {
+      auto remaining = m_interval - (chrono::system_clock::now() - m_lastpoll);
+      timeout = std::max(chrono::milliseconds{0},
+          std::min(timeout, chrono::duration_cast<chrono::milliseconds>(remaining)));
     }
 
-    inotify_module::idle();
+    if (m_uevent) {
+      m_uevent->poll(timeout.count());
+    } else {
+      sleep(timeout);
+    }
   }
 
   /**
-   * Update values when tracked files have changed
+   * Check for uevents reported for the battery or the adapter.
+   *
+   * If the defined interval has been reached, trigger a
+   * manual poll since not all batteries report a uevent
+   * when the capacity changes.
    */
-  bool battery_module::on_event(inotify_event* event) {
-    if (event != nullptr) {
-      m_log.trace("%s: Inotify event reported for %s", name(), event->filename);
+  bool battery_module::has_event() {
+    bool changed{false};
+
+    if (m_uevent) {
+      uevent_util::event evt;
+      while (m_uevent->receive(evt)) {
+        auto supply = evt.get("POWER_SUPPLY_NAME");
+        if (supply == m_battery || supply == m_adapter) {
+          m_log.trace("%s: Uevent '%s' reported for %s", name(), evt.action, supply);
+          changed = true;
+        }
+      }
     }
 
+    if (!changed && m_interval.count() > 0 && chrono::system_clock::now() - m_lastpoll >= m_interval) {
+      m_log.trace("%s: Polling values", name());
+      changed = true;
+    }
+
+    return changed;
+  }
+
+  /**
+   * Update values when the battery or adapter has changed
+   */
+  bool battery_module::update() {
     // Reset timer to avoid unnecessary polling
     m_lastpoll = chrono::system_clock::now();
 
@@ -156,7 +177,11 @@ namespace modules {
       percentage = current_percentage();
     }
 
-    if (event != nullptr && state == m_state && percentage == m_percentage && m_unchanged--) {
+    if (!m_timeformat.empty()) {
+      sample_rate(state);
+    }
+
+    if (state == m_state && percentage == m_percentage && m_unchanged--) {
       return false;
     }
 
@@ -223,13 +248,7 @@ namespace modules {
    * Get the current battery state
    */
   battery_state battery_module::current_state() {
-    auto adapter_status = file_util::get_contents(m_valuepath[battery_value::ADAPTER]);
-
-    if (adapter_status.empty()) {
-      return battery_state::DISCHARGING;
-    } else if (adapter_status[0] == '0') {
-      return battery_state::DISCHARGING;
-    } else if (adapter_status[0] != '1') {
+    if (read_value(battery_value::ADAPTER) != 1) {
       return battery_state::DISCHARGING;
     } else if (m_percentage < m_fullat) {
       return battery_state::CHARGING;
@@ -242,8 +261,7 @@ namespace modules {
    * Get the current capacity level
    */
   int battery_module::current_percentage() {
-    auto capacity = file_util::get_contents(m_valuepath[battery_value::CAPACITY_PERC]);
-    auto value = math_util::cap<int>(std::atof(capacity.c_str()), 0, 100);
+    auto value = math_util::cap<int>(read_value(battery_value::CAPACITY_PERC), 0, 100);
 
     if (value >= m_fullat) {
       return 100;
@@ -260,10 +278,10 @@ namespace modules {
       return "";
     }
 
-    int rate{atoi(file_util::get_contents(m_valuepath[battery_value::RATE]).c_str()) / 1000};
-    int volt{atoi(file_util::get_contents(m_valuepath[battery_value::VOLTAGE]).c_str()) / 1000};
-    int now{atoi(file_util::get_contents(m_valuepath[battery_value::CAPACITY]).c_str()) / 1000};
-    int max{atoi(file_util::get_contents(m_valuepath[battery_value::CAPACITY_MAX]).c_str()) / 1000};
+    int rate{static_cast<int>(m_rate.get() / 1000)};
+    int volt{read_value(battery_value::VOLTAGE) / 1000};
+    int now{read_value(battery_value::CAPACITY) / 1000};
+    int max{read_value(battery_value::CAPACITY_MAX) / 1000};
     int cap{0};
 
     if (m_state == battery_state::CHARGING) {
@@ -303,6 +321,35 @@ namespace modules {
     return {buffer};
   }
 
+  /**
+   * Add the current dis-/charge rate to the samples used
+   * for the time estimate, the samples are discarded when
+   * switching between charging and discharging
+   */
+  void battery_module::sample_rate(battery_state state) {
+    if (state != m_state) {
+      m_rate.clear();
+    }
+
+    if (state != battery_state::FULL) {
+      // Some drivers report a negative rate while discharging and
+      // briefly report a zero rate after the adapter state changed
+      auto rate = std::abs(read_value(battery_value::RATE));
+
+      if (rate > 0) {
+        m_rate.push(rate);
+      }
+    }
+  }
+
+  /**
+   * Re-read the numeric value of given sysfs file
+   */
+  int battery_module::read_value(battery_value value) {
+    auto contents = m_values[value]->read();
+    return contents != nullptr ? atoi(contents) : 0;
+  }
+
   /**
    * Subthread runner that emit update events
    * to refresh <animation-charging> in case it is used.
@@ -14,6 +14,25 @@ namespace modules {
   template class module<bspwm_module>;
   template class event_module<bspwm_module>;
 
+  namespace {
+    /**
+     * Get the workspace state matching given report flag
+     */
+    state_ws workspace_state(char flag) {
+      switch (flag) {
+        case 'o':
+          return state_ws::WORKSPACE_OCCUPIED;
+        case 'U':
+        case 'u':
+          return state_ws::WORKSPACE_URGENT;
+        case 'f':
+          return state_ws::WORKSPACE_EMPTY;
+        default:
+          return state_ws::WORKSPACE_ACTIVE;
+      }
+    }
+  }
+
   void bspwm_module::setup() {  // {{{
     // Create ipc subscriber
     m_subscriber = bspwm_util::make_subscriber();
@@ -87,6 +106,10 @@ namespace modules {
     if (m_subscriber->poll(POLLHUP, 0)) {
       m_log.warn("%s: Reconnecting to socket...", name());
       m_subscriber = bspwm_util::make_subscriber();
+      // Drop the partial report of the old connection and
+      // force a full rebuild from the first new report
+      m_reader = bspwm_util::report_reader{};
+      m_state.clear();
     }
 
     ssize_t bytes = 0;
@@ -96,207 +119,186 @@ namespace modules {
 
   bool bspwm_module::update() {  // {{{
     ssize_t bytes = 0;
-    string data = m_subscriber->receive(BUFSIZ - 1, bytes, 0);
+    bool complete = false;
 
-    if (bytes == 0)
-      return false;
+    // Drain the socket so that only the most recent report gets parsed
+    do {
+      auto data = m_subscriber->receive(BUFSIZ - 1, bytes, 0);
+      if (bytes == 0) {
+        break;
+      }
+      complete = m_reader.feed(data.c_str(), data.size()) || complete;
+    } while (m_subscriber->poll(POLLIN, 0));
 
-    data = string_util::strip_trailing_newline(data);
+    if (!complete) {
+      return false;
+    }
 
-    unsigned long pos;
-    while ((pos = data.find("\n")) != string::npos) data.erase(pos);
+    vector<bspwm_util::monitor_state> state;
 
-    if (data.empty())
+    if (!bspwm_util::parse_report(m_reader.report(), state)) {
+      m_log.err("%s: Unknown status '%s'", name(), m_reader.report());
       return false;
+    }
 
-    const auto prefix = string{BSPWM_STATUS_PREFIX};
-
-    // If there were more than 1 row available in the channel
-    // we'll strip out the old updates
-    if ((pos = data.find_last_of(prefix)) > 0)
-      data = data.substr(pos);
+    // Only keep the state of the defined monitor
+    if (m_pinworkspaces) {
+      state.erase(std::remove_if(state.begin(), state.end(),
+                      [&](const bspwm_util::monitor_state& mon) { return mon.name != m_bar.monitor->name; }),
+          state.end());
+    }
 
-    if (data.compare(0, prefix.length(), prefix) != 0) {
-      m_log.err("%s: Unknown status '%s'", name(), data);
+    if (state == m_state) {
       return false;
     }
 
-    unsigned long hash;
-    if ((hash = string_util::hash(data)) == m_hash)
-      return false;
-    m_hash = hash;
+    vector<unique_ptr<bspwm_monitor>> monitors;
+    monitors.reserve(state.size());
 
-    // Extract the string for the defined monitor
-    if (m_pinworkspaces) {
-      const auto needle_active = ":M" + m_bar.monitor->name + ":";
-      const auto needle_inactive = ":m" + m_bar.monitor->name + ":";
-
-      if ((pos = data.find(prefix)) != string::npos)
-        data = data.replace(pos, prefix.length(), ":");
-      if ((pos = data.find(needle_active)) != string::npos)
-        data.erase(0, pos + 1);
-      if ((pos = data.find(needle_inactive)) != string::npos)
-        data.erase(0, pos + 1);
-      if ((pos = data.find(":m", 1)) != string::npos)
-        data.erase(pos);
-      if ((pos = data.find(":M", 1)) != string::npos)
-        data.erase(pos);
-    } else if ((pos = data.find(prefix)) != string::npos) {
-      data = data.replace(pos, prefix.length(), ":");
-    } else {
-      return false;
+    for (size_t i = 0; i < state.size(); i++) {
+      if (i < m_state.size() && state[i] == m_state[i]) {
+        monitors.emplace_back(move(m_monitors[i]));
+      } else if (i < m_state.size()) {
+        monitors.emplace_back(create_monitor(state[i], m_monitors[i].get(), &m_state[i]));
+      } else {
+        monitors.emplace_back(create_monitor(state[i], nullptr, nullptr));
+      }
     }
 
-    int workspace_n = 0;
+    m_monitors = move(monitors);
+    m_state = move(state);
 
-    m_monitors.clear();
+    return true;
+  }  // }}}
 
-    for (auto&& tag : string_util::split(data, ':')) {
-      if (tag.empty()) {
-        continue;
-      }
+  /**
+   * Create the labels for given monitor state, reusing the
+   * workspace labels of the previous state that are unchanged
+   */
+  unique_ptr<bspwm_monitor> bspwm_module::create_monitor(const bspwm_util::monitor_state& state,
+      bspwm_monitor* previous, const bspwm_util::monitor_state* previous_state) {  // {{{
+    auto monitor = make_unique<bspwm_monitor>();
+    monitor->name = state.name;
+    monitor->focused = state.focused;
+
+    if (m_monitorlabel) {
+      monitor->label = m_monitorlabel->clone();
+      monitor->label->replace_token("%name%", state.name);
+    }
 
-      auto value = tag.size() > 0 ? tag.substr(1) : "";
-      auto workspace_flag = state_ws::WORKSPACE_NONE;
-      auto mode_flag = state_mode::MODE_NONE;
+    if (m_formatter->has(TAG_LABEL_STATE)) {
+      bool reuse = previous != nullptr && previous_state->name == state.name && previous_state->focused == state.focused;
 
-      if (tag[0] == 'm' || tag[0] == 'M') {
-        m_monitors.emplace_back(make_unique<bspwm_monitor>());
-        m_monitors.back()->name = value;
+      for (size_t i = 0; i < state.desktops.size(); i++) {
+        auto& desktop = state.desktops[i];
+        auto flag = workspace_state(desktop.flag);
 
-        if (m_monitorlabel) {
-          m_monitors.back()->label = m_monitorlabel->clone();
-          m_monitors.back()->label->replace_token("%name%", value);
+        if (reuse && i < previous_state->desktops.size() && i < previous->workspaces.size() &&
+            previous_state->desktops[i] == desktop) {
+          monitor->workspaces.emplace_back(make_pair(flag, move(previous->workspaces[i].second)));
+        } else {
+          monitor->workspaces.emplace_back(make_pair(flag, create_workspace_label(flag, desktop.name, state.focused, i + 1)));
         }
       }
+    }
 
-      switch (tag[0]) {
-        case 'm':
-          m_monitors.back()->focused = false;
-          break;
-        case 'M':
-          m_monitors.back()->focused = true;
-          break;
-        case 'F':
-          workspace_flag = state_ws::WORKSPACE_ACTIVE;
-          break;
-        case 'O':
-          workspace_flag = state_ws::WORKSPACE_ACTIVE;
-          break;
-        case 'o':
-          workspace_flag = state_ws::WORKSPACE_OCCUPIED;
-          break;
-        case 'U':
-          workspace_flag = state_ws::WORKSPACE_URGENT;
+    create_modes(state, *monitor);
+
+    return monitor;
+  }  // }}}
+
+  /**
+   * Create the label for given desktop
+   */
+  label_t bspwm_module::create_workspace_label(
+      state_ws flag, const string& ws_name, bool focused, size_t index) const {  // {{{
+    auto icon = m_icons->get(ws_name, DEFAULT_WS_ICON);
+    auto label = m_statelabels.find(flag)->second->clone();
+
+    if (!focused) {
+      label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED)->second);
+      switch (flag) {
+        case state_ws::WORKSPACE_ACTIVE:
+          label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_ACTIVE)->second);
           break;
-        case 'u':
-          workspace_flag = state_ws::WORKSPACE_URGENT;
+        case state_ws::WORKSPACE_OCCUPIED:
+          label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_OCCUPIED)->second);
           break;
-        case 'f':
-          workspace_flag = state_ws::WORKSPACE_EMPTY;
+        case state_ws::WORKSPACE_URGENT:
+          label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_URGENT)->second);
           break;
-        case 'L':
-          switch (value[0]) {
-            case 0:
-              break;
-            case 'M':
-              mode_flag = state_mode::MODE_LAYOUT_MONOCLE;
-              break;
-            case 'T':
-              mode_flag = state_mode::MODE_LAYOUT_TILED;
-              break;
-            default:
-              m_log.warn("%s: Undefined L => '%s'", name(), value);
-          }
+        case state_ws::WORKSPACE_EMPTY:
+          label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_EMPTY)->second);
           break;
-
-        case 'T':
-          switch (value[0]) {
-            case 0:
-              break;
-            case 'T':
-              break;
-            case '=':
-              mode_flag = state_mode::MODE_STATE_FULLSCREEN;
-              break;
-            case 'F':
-              mode_flag = state_mode::MODE_STATE_FLOATING;
-              break;
-            default:
-              m_log.warn("%s: Undefined T => '%s'", name(), value);
-          }
+        default:
           break;
+      }
+    }
 
-        case 'G':
-          if (!m_monitors.back()->focused) {
-            break;
-          }
+    label->reset_tokens();
+    label->replace_token("%name%", ws_name);
+    label->replace_token("%icon%", icon->get());
+    label->replace_token("%index%", to_string(index));
 
-          for (int i = 0; i < (int)value.length(); i++) {
-            switch (value[i]) {
-              case 0:
-                break;
-              case 'L':
-                mode_flag = state_mode::MODE_NODE_LOCKED;
-                break;
-              case 'S':
-                mode_flag = state_mode::MODE_NODE_STICKY;
-                break;
-              case 'P':
-                mode_flag = state_mode::MODE_NODE_PRIVATE;
-                break;
-              default:
-                m_log.warn("%s: Undefined G => '%s'", name(), value.substr(i, 1));
-            }
-
-            if (mode_flag != state_mode::MODE_NONE && !m_modelabels.empty()) {
-              m_monitors.back()->modes.emplace_back(m_modelabels.find(mode_flag)->second->clone());
-            }
-          }
-          continue;
+    return label;
+  }  // }}}
 
-        default:
-          m_log.warn("%s: Undefined tag => '%s'", name(), tag.substr(0, 1));
-      }
+  /**
+   * Create the mode labels for the focused node of given monitor
+   */
+  void bspwm_module::create_modes(const bspwm_util::monitor_state& state, bspwm_monitor& monitor) const {  // {{{
+    if (m_modelabels.empty()) {
+      return;
+    }
 
-      if (workspace_flag != state_ws::WORKSPACE_NONE && m_formatter->has(TAG_LABEL_STATE)) {
-        auto icon = m_icons->get(value, DEFAULT_WS_ICON);
-        auto label = m_statelabels.find(workspace_flag)->second->clone();
-
-        if (!m_monitors.back()->focused) {
-          label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED)->second);
-          switch (workspace_flag) {
-            case state_ws::WORKSPACE_ACTIVE:
-              label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_ACTIVE)->second);
-              break;
-            case state_ws::WORKSPACE_OCCUPIED:
-              label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_OCCUPIED)->second);
-              break;
-            case state_ws::WORKSPACE_URGENT:
-              label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_URGENT)->second);
-              break;
-            case state_ws::WORKSPACE_EMPTY:
-              label->replace_defined_values(m_statelabels.find(state_ws::WORKSPACE_DIMMED_EMPTY)->second);
-              break;
-            default:
-              break;
-          }
-        }
+    auto add_mode = [&](state_mode mode) { monitor.modes.emplace_back(m_modelabels.find(mode)->second->clone()); };
+
+    switch (state.layout) {
+      case 0:
+        break;
+      case 'M':
+        add_mode(state_mode::MODE_LAYOUT_MONOCLE);
+        break;
+      case 'T':
+        add_mode(state_mode::MODE_LAYOUT_TILED);
+        break;
+      default:
+        m_log.warn("%s: Undefined L => '%c'", name(), state.layout);
+    }
 
-        label->reset_tokens();
-        label->replace_token("%name%", value);
-        label->replace_token("%icon%", icon->get());
-        label->replace_token("%index%", to_string(++workspace_n));
+    switch (state.state) {
+      case 0:
+      case 'T':
+        break;
+      case '=':
+        add_mode(state_mode::MODE_STATE_FULLSCREEN);
+        break;
+      case 'F':
+        add_mode(state_mode::MODE_STATE_FLOATING);
+        break;
+      default:
+        m_log.warn("%s: Undefined T => '%c'", name(), state.state);
+    }
 
-        m_monitors.back()->workspaces.emplace_back(make_pair(workspace_flag, move(label)));
-      }
+    if (!state.focused) {
+      return;
+    }
 
-      if (mode_flag != state_mode::MODE_NONE && !m_modelabels.empty()) {
-        m_monitors.back()->modes.emplace_back(m_modelabels.find(mode_flag)->second->clone());
+    for (auto&& flag : state.flags) {
+      switch (flag) {
+        case 'L':
+          add_mode(state_mode::MODE_NODE_LOCKED);
+          break;
+        case 'S':
+          add_mode(state_mode::MODE_NODE_STICKY);
+          break;
+        case 'P':
+          add_mode(state_mode::MODE_NODE_PRIVATE);
+          break;
+        default:
+          m_log.warn("%s: Undefined G => '%c'", name(), flag);
       }
     }
-
-    return true;
   }  // }}}
 
   string bspwm_module::get_output() {  // {{{
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "modules/cpu.hpp"
 
 #include "drawtypes/label.hpp"
@@ -14,17 +17,39 @@ namespace modules {
   template class module<cpu_module>;
   template class timer_module<cpu_module>;
 
+  namespace {
+    /**
+     * Parse the unsigned integer at the given position
+     * and move the position past it
+     */
+    unsigned long long parse_counter(const char*& pos) {
+      while (*pos == ' ') {
+        pos++;
+      }
+      unsigned long long value{0};
+      while (*pos >= '0' && *pos <= '9') {
+        value = value * 10 + (*pos++ - '0');
+      }
+      return value;
+    }
+  }
+
   void cpu_module::setup() {
     m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 1));
 
+    m_stat = make_unique<file_util::pread_reader>(PATH_CPU_INFO);
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
 
     if (m_formatter->has(TAG_BAR_LOAD))
       m_barload = load_progressbar(m_bar, m_conf, name(), TAG_BAR_LOAD);
     if (m_formatter->has(TAG_RAMP_LOAD))
       m_rampload = load_ramp(m_conf, name(), TAG_RAMP_LOAD);
-    if (m_formatter->has(TAG_RAMP_LOAD_PER_CORE))
+    if (m_formatter->has(TAG_RAMP_LOAD_PER_CORE)) {
       m_rampload_core = load_ramp(m_conf, name(), TAG_RAMP_LOAD_PER_CORE);
+      m_buckets = m_conf.get<size_t>(name(), "ramp-coreload-buckets", 0);
+      m_spacing = m_conf.get<int>(name(), "ramp-coreload-spacing", 1);
+    }
     if (m_formatter->has(TAG_LABEL))
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "%percentage%");
 
@@ -37,22 +62,11 @@ namespace modules {
     if (!read_values())
       return false;
 
-    m_total = 0.0f;
-    m_load.clear();
-
-    auto cores_n = m_cputimes.size();
+    read_loads();
 
-    if (!cores_n)
+    if (m_load.empty())
       return false;
 
-    for (size_t i = 0; i < cores_n; i++) {
-      auto load = get_load(i);
-      m_total += load;
-      m_load.emplace_back(load);
-    }
-
-    m_total = m_total / static_cast<float>(cores_n);
-
     if (m_label) {
       m_label->reset_tokens();
       m_label->replace_token("%percentage%", to_string(static_cast<int>(m_total + 0.5f)) + "%");
@@ -69,68 +83,108 @@ namespace modules {
     else if (tag == TAG_RAMP_LOAD)
       builder->node(m_rampload->get_by_percentage(m_total));
     else if (tag == TAG_RAMP_LOAD_PER_CORE) {
-      auto i = 0;
-      for (auto&& load : m_load) {
-        if (i++ > 0)
-          builder->space(1);
-        builder->node(m_rampload_core->get_by_percentage(load));
+      const auto& loads = m_buckets > 0 ? m_bucketload : m_load;
+      for (size_t i = 0; i < loads.size(); i++) {
+        if (i > 0 && m_spacing > 0)
+          builder->space(m_spacing);
+        builder->node(m_rampload_core->get_by_percentage(loads[i]));
       }
-      builder->node(builder->flush());
     } else
       return false;
     return true;
   }
 
+  /**
+   * Read the per core counters from /proc/stat, the
+   * file is parsed in place without any allocations
+   * once the arrays have grown to the amount of cores
+   */
   bool cpu_module::read_values() {
-    m_cputimes_prev.swap(m_cputimes);
+    std::swap(m_cputimes_prev, m_cputimes);
     m_cputimes.clear();
 
-    try {
-      std::ifstream in(PATH_CPU_INFO);
-      string str;
-
-      while (std::getline(in, str) && str.compare(0, 3, "cpu") == 0) {
-        // skip line with accumulated value
-        if (str.compare(0, 4, "cpu ") == 0)
-          continue;
+    auto pos = m_stat->read();
 
-        auto values = string_util::split(str, ' ');
-
-        m_cputimes.emplace_back(new cpu_time);
-        m_cputimes.back()->user = std::stoull(values[1].c_str(), 0, 10);
-        m_cputimes.back()->nice = std::stoull(values[2].c_str(), 0, 10);
-        m_cputimes.back()->system = std::stoull(values[3].c_str(), 0, 10);
-        m_cputimes.back()->idle = std::stoull(values[4].c_str(), 0, 10);
-        m_cputimes.back()->total =
-            m_cputimes.back()->user + m_cputimes.back()->nice + m_cputimes.back()->system + m_cputimes.back()->idle;
-      }
-    } catch (const std::ios_base::failure& e) {
-      m_log.err("Failed to read CPU values (what: %s)", e.what());
+    if (pos == nullptr) {
+      m_log.err("%s: Failed to read CPU values (%s)", name(), strerror(errno));
+      return false;
     }
 
-    return !m_cputimes.empty();
-  }
+    while (strncmp(pos, "cpu", 3) == 0) {
+      pos += 3;
 
-  float cpu_module::get_load(size_t core) const {
-    if (m_cputimes.empty() || m_cputimes_prev.empty())
-      return 0;
-    else if (core >= m_cputimes.size() || core >= m_cputimes_prev.size())
-      return 0;
+      // Only the per core lines (cpuN) are parsed, the line
+      // with the accumulated values of all cores is skipped
+      if (*pos >= '0' && *pos <= '9') {
+        // skip the core index
+        parse_counter(pos);
 
-    auto& last = m_cputimes[core];
-    auto& prev = m_cputimes_prev[core];
+        auto user = parse_counter(pos);
+        auto nice = parse_counter(pos);
+        auto system = parse_counter(pos);
+        auto idle = parse_counter(pos);
 
-    auto last_idle = last->idle;
-    auto prev_idle = prev->idle;
+        m_cputimes.idle.emplace_back(idle);
+        m_cputimes.total.emplace_back(user + nice + system + idle);
+      }
 
-    auto diff = last->total - prev->total;
+      if ((pos = strchr(pos, '\n')) == nullptr)
+        break;
+      pos++;
+    }
 
-    if (diff == 0)
-      return 0;
+    return m_cputimes.size() > 0;
+  }
 
-    float percentage = 100.0f * (diff - (last_idle - prev_idle)) / diff;
+  /**
+   * Calculate the load of all cores from the difference
+   * between the two latest samples, written as a plain loop
+   * over the counter arrays so that it can be vectorized
+   */
+  void cpu_module::read_loads() {
+    // Cores without a previous sample, e.g. on the first
+    // update, are reported as idle
+    auto cores = m_cputimes.size();
+    auto sampled = std::min(cores, m_cputimes_prev.size());
+    auto total = m_cputimes.total.data();
+    auto total_prev = m_cputimes_prev.total.data();
+    auto idle = m_cputimes.idle.data();
+    auto idle_prev = m_cputimes_prev.idle.data();
+
+    m_load.resize(cores);
+    auto load = m_load.data();
+
+    for (size_t i = 0; i < sampled; i++) {
+      float diff = total[i] - total_prev[i];
+      float busy = diff - (idle[i] - idle_prev[i]);
+      load[i] = diff > 0 ? 100.0f * busy / diff : 0.0f;
+    }
+    std::fill(load + sampled, load + cores, 0.0f);
+
+    m_total = 0.0f;
+    for (size_t i = 0; i < cores; i++) {
+      load[i] = math_util::cap<float>(load[i], 0, 100);
+      m_total += load[i];
+    }
 
-    return math_util::cap<float>(percentage, 0, 100);
+    if (cores > 0)
+      m_total /= static_cast<float>(cores);
+
+    // Group neighbouring cores into a fixed amount of buckets
+    // holding their average load
+    if (m_buckets > 0) {
+      auto buckets = std::min(m_buckets, cores);
+      m_bucketload.assign(buckets, 0.0f);
+
+      for (size_t b = 0; b < buckets; b++) {
+        auto first = b * cores / buckets;
+        auto last = (b + 1) * cores / buckets;
+        for (size_t i = first; i < last; i++) {
+          m_bucketload[b] += load[i];
+        }
+        m_bucketload[b] /= static_cast<float>(last - first);
+      }
+    }
   }
 }
 
@@ -13,29 +13,30 @@ namespace modules {
     if (!m_bar.locale.empty())
       setlocale(LC_TIME, m_bar.locale.c_str());
 
-    m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 1));
-
     m_formatter->add(DEFAULT_FORMAT, TAG_DATE, {TAG_DATE});
 
-    m_format = m_conf.get<string>(name(), "date");
-    m_formatalt = m_conf.get<string>(name(), "date-alt", "");
+    m_format = make_unique<time_util::formatter>(m_conf.get<string>(name(), "date"));
+    auto formatalt = m_conf.get<string>(name(), "date-alt", "");
+    if (!formatalt.empty())
+      m_formatalt = make_unique<time_util::formatter>(formatalt);
+
+    // Formats without seconds only need to be updated when the minute changes
+    auto seconds = m_format->seconds() || (m_formatalt && m_formatalt->seconds());
+
+    m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", seconds ? 1 : 60));
+    m_aligned = m_conf.get<bool>(name(), "align", true);
   }
 
   bool date_module::update() {
     if (!m_formatter->has(TAG_DATE))
       return false;
 
-    auto time = std::time(nullptr);
-    auto date_format = m_toggled ? m_formatalt : m_format;
-    char buffer[256] = {'\0'};
-
-    std::strftime(buffer, sizeof(buffer), date_format.c_str(), std::localtime(&time));
+    auto& date = (m_toggled && m_formatalt ? m_formatalt : m_format)->format(std::time(nullptr));
 
-    if (std::strncmp(buffer, m_buffer, sizeof(buffer)) == 0)
+    if (date == m_date)
       return false;
-    else
-      std::memmove(m_buffer, buffer, sizeof(buffer));
 
+    m_date = date;
     return true;
   }
 
@@ -44,10 +45,10 @@ namespace modules {
       return false;
     }
 
-    if (!m_formatalt.empty())
+    if (m_formatalt)
       m_builder->cmd(mousebtn::LEFT, EVENT_TOGGLE);
 
-    builder->node(m_buffer);
+    builder->node(m_date);
 
     return true;
   }
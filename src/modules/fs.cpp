@@ -27,6 +27,7 @@ namespace modules {
     m_fixed = m_conf.get<bool>(name(), "fixed-values", m_fixed);
     m_spacing = m_conf.get<int>(name(), "spacing", m_spacing);
     m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 30));
+    m_mtab = mtab_util::get_mountinfo();
 
     // Add formats and elements
     m_formatter->add(
@@ -46,48 +47,42 @@ namespace modules {
   }
 
   /**
-   * Update values by reading mtab entries
+   * Update values using the shared mount table
+   * and the filesystem stats of each mountpoint
    */
   bool fs_module::update() {
     m_mounts.clear();
 
     struct statvfs buffer;
-    struct mntent* mnt = nullptr;
+    mtab_util::mount_entry entry;
 
     for (auto&& mountpoint : m_mountpoints) {
       m_mounts.emplace_back(new fs_mount{mountpoint, false});
 
-      if (statvfs(mountpoint.c_str(), &buffer) == -1) {
+      if (!m_mtab->find(mountpoint, entry) || statvfs(mountpoint.c_str(), &buffer) == -1) {
         continue;
       }
 
-      auto mtab = make_unique<mtab_util::reader>();
       auto& mount = m_mounts.back();
 
-      while (mtab->next(&mnt)) {
-        if (string{mnt->mnt_dir} != mountpoint) {
-          continue;
-        }
+      mount->mounted = true;
+      mount->mountpoint = entry.mountpoint;
+      mount->type = entry.type;
+      mount->fsname = entry.fsname;
 
-        mount->mounted = true;
-        mount->mountpoint = mnt->mnt_dir;
-        mount->type = mnt->mnt_type;
-        mount->fsname = mnt->mnt_fsname;
+      auto b_total = buffer.f_bsize * buffer.f_blocks;
+      auto b_free = buffer.f_bsize * buffer.f_bfree;
+      auto b_used = b_total - b_free;
 
-        auto b_total = buffer.f_bsize * buffer.f_blocks;
-        auto b_free = buffer.f_bsize * buffer.f_bfree;
-        auto b_used = b_total - b_free;
+      mount->bytes_total = b_total;
+      mount->bytes_free = b_free;
+      mount->bytes_used = b_used;
 
-        mount->bytes_total = b_total;
-        mount->bytes_free = b_free;
-        mount->bytes_used = b_used;
+      mount->percentage_free = math_util::percentage<unsigned long long, float>(b_free, 0, b_total);
+      mount->percentage_used = math_util::percentage<unsigned long long, float>(b_used, 0, b_total);
 
-        mount->percentage_free = math_util::percentage<unsigned long long, float>(b_free, 0, b_total);
-        mount->percentage_used = math_util::percentage<unsigned long long, float>(b_used, 0, b_total);
-
-        mount->percentage_free_s = string_util::floatval(mount->percentage_free, 2, m_fixed, m_bar.locale);
-        mount->percentage_used_s = string_util::floatval(mount->percentage_used, 2, m_fixed, m_bar.locale);
-      }
+      mount->percentage_free_s = string_util::floatval(mount->percentage_free, 2, m_fixed, m_bar.locale);
+      mount->percentage_used_s = string_util::floatval(mount->percentage_used, 2, m_fixed, m_bar.locale);
     }
 
     return true;
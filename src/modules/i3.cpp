@@ -51,6 +51,10 @@ namespace modules {
     }
 
     try {
+      // Queue the workspace events so that they can be applied
+      // to the cached workspace table in the next update
+      m_ipc.signal_workspace_event.connect(
+          [this](const i3ipc::workspace_event_t& evt) { m_events.emplace_back(evt); });
       m_ipc.subscribe(i3ipc::ET_WORKSPACE);
       m_ipc.prepare_to_event_handling();
     } catch (std::exception& err) {
@@ -74,70 +78,29 @@ namespace modules {
   }  // }}}
 
   bool i3_module::update() {  // {{{
-    m_workspaces.clear();
-    i3_util::connection_t ipc;
-
     try {
-      auto workspaces = ipc.get_workspaces();
-      vector<shared_ptr<i3ipc::workspace_t>> sorted = workspaces;
-      string focused_output;
+      auto count = m_workspaces.size();
 
-      for (auto&& workspace : workspaces)
-        if (workspace->focused) {
-          focused_output = workspace->output;
-          break;
+      for (auto&& evt : m_events) {
+        if (!m_refresh && !apply_event(evt)) {
+          m_refresh = true;
         }
-
-      if (m_indexsort) {
-        using ws_t = shared_ptr<i3ipc::workspace_t>;
-        // clang-format off
-        sort(sorted.begin(), sorted.end(), [](ws_t ws1, ws_t ws2){
-            return ws1->num < ws2->num;
-        });
-        // clang-format on
       }
 
-      for (auto&& workspace : sorted) {
-        if (m_pinworkspaces && workspace->output != m_bar.monitor->name)
-          continue;
-
-        auto flag = i3_flag::WORKSPACE_NONE;
-        if (workspace->focused)
-          flag = i3_flag::WORKSPACE_FOCUSED;
-        else if (workspace->urgent)
-          flag = i3_flag::WORKSPACE_URGENT;
-        else if (!workspace->visible || (workspace->visible && workspace->output != focused_output))
-          flag = i3_flag::WORKSPACE_UNFOCUSED;
-        else
-          flag = i3_flag::WORKSPACE_VISIBLE;
-
-        string wsname{workspace->name};
-
-        // Remove workspace numbers "0:"
-        if (m_strip_wsnumbers)
-          wsname.erase(0, string_util::find_nth(wsname, 0, ":", 1) + 1);
-
-        // Trim leading and trailing whitespace
-        wsname = string_util::trim(wsname, ' ');
-
-        // Cap at configured max length
-        if (m_wsname_maxlen > 0 && wsname.length() > m_wsname_maxlen)
-          wsname.erase(m_wsname_maxlen);
-
-        auto icon = m_icons->get(workspace->name, DEFAULT_WS_ICON);
-        auto label = m_statelabels.find(flag)->second->clone();
-
-        label->reset_tokens();
-        label->replace_token("%output%", workspace->output);
-        label->replace_token("%name%", wsname);
-        label->replace_token("%icon%", icon->get());
-        label->replace_token("%index%", to_string(workspace->num));
-        m_workspaces.emplace_back(make_unique<i3_workspace>(workspace->num, flag, std::move(label)));
+      m_events.clear();
+
+      bool changed{m_workspaces.size() != count};
+
+      if (m_refresh) {
+        load_workspaces();
+        m_refresh = false;
+        changed = true;
       }
 
-      return true;
+      return update_labels() || changed;
     } catch (const std::exception& err) {
       m_log.err("%s: %s", name(), err.what());
+      m_refresh = true;
       return false;
     }
   }  // }}}
@@ -152,7 +115,9 @@ namespace modules {
     }
 
     for (auto&& ws : m_workspaces) {
-      if (m_click) {
+      if (!ws->label) {
+        continue;
+      } else if (m_click) {
         builder->cmd(mousebtn::LEFT, string{EVENT_CLICK} + to_string(ws.get()->index));
         builder->node(ws.get()->label);
         builder->cmd_close(true);
@@ -174,17 +139,17 @@ namespace modules {
       return false;
 
     try {
-      i3_util::connection_t ipc;
+      std::lock_guard<std::mutex> guard(m_ipclock);
 
       if (cmd.compare(0, strlen(EVENT_CLICK), EVENT_CLICK) == 0) {
         m_log.info("%s: Sending workspace focus command to ipc handler", name());
-        ipc.send_command("workspace number " + cmd.substr(strlen(EVENT_CLICK)));
+        m_ipc.send_command("workspace number " + cmd.substr(strlen(EVENT_CLICK)));
       } else if (cmd.compare(0, strlen(EVENT_SCROLL_DOWN), EVENT_SCROLL_DOWN) == 0) {
         m_log.info("%s: Sending workspace prev command to ipc handler", name());
-        ipc.send_command("workspace next_on_output");
+        m_ipc.send_command("workspace next_on_output");
       } else if (cmd.compare(0, strlen(EVENT_SCROLL_UP), EVENT_SCROLL_UP) == 0) {
         m_log.info("%s: Sending workspace next command to ipc handler", name());
-        ipc.send_command("workspace prev_on_output");
+        m_ipc.send_command("workspace prev_on_output");
       }
     } catch (const std::exception& err) {
       m_log.err("%s: %s", name(), err.what());
@@ -192,6 +157,194 @@ namespace modules {
 
     return true;
   }  // }}}
+
+  /**
+   * Apply workspace event to the cached workspace table
+   *
+   * @return false if the event can't be applied and
+   *         the workspaces have to be fetched again
+   */
+  bool i3_module::apply_event(const i3ipc::workspace_event_t& evt) {  // {{{
+    if (!evt.current) {
+      return false;
+    }
+
+    auto current = find_workspace(evt.current->name);
+
+    switch (evt.type) {
+      case i3ipc::WorkspaceEventType::FOCUS: {
+        if (current == nullptr) {
+          return false;
+        }
+
+        auto old = evt.old ? find_workspace(evt.old->name) : nullptr;
+        if (old != nullptr) {
+          old->focused = false;
+        }
+
+        // Focusing a workspace hides the one previously shown on its output
+        for (auto&& ws : m_workspaces) {
+          if (ws->output == current->output) {
+            ws->visible = false;
+          }
+        }
+
+        current->focused = true;
+        current->visible = true;
+        current->urgent = evt.current->urgent;
+        m_focused_output = current->output;
+        return true;
+      }
+
+      case i3ipc::WorkspaceEventType::URGENT:
+        if (current == nullptr) {
+          return false;
+        }
+        current->urgent = evt.current->urgent;
+        return true;
+
+      case i3ipc::WorkspaceEventType::EMPTY:
+        m_workspaces.erase(std::remove_if(m_workspaces.begin(), m_workspaces.end(),
+                               [&](const i3_workspace_t& ws) { return ws.get() == current; }),
+            m_workspaces.end());
+        return true;
+
+      default:
+        return false;
+    }
+  }  // }}}
+
+  /**
+   * Fetch all workspaces, keeping the labels
+   * of the ones that are already known
+   */
+  void i3_module::load_workspaces() {  // {{{
+    vector<shared_ptr<i3ipc::workspace_t>> workspaces;
+    {
+      std::lock_guard<std::mutex> guard(m_ipclock);
+      workspaces = m_ipc.get_workspaces();
+    }
+
+    vector<i3_workspace_t> table;
+    table.reserve(workspaces.size());
+
+    for (auto&& workspace : workspaces) {
+      i3_workspace_t ws;
+
+      for (auto&& cached : m_workspaces) {
+        if (cached && cached->name == workspace->name && cached->index == workspace->num &&
+            cached->output == workspace->output) {
+          ws = move(cached);
+          break;
+        }
+      }
+
+      if (!ws) {
+        ws = make_unique<i3_workspace>(workspace->num, workspace->name);
+        ws->output = workspace->output;
+      }
+
+      ws->focused = workspace->focused;
+      ws->visible = workspace->visible;
+      ws->urgent = workspace->urgent;
+
+      if (ws->focused) {
+        m_focused_output = ws->output;
+      }
+
+      table.emplace_back(move(ws));
+    }
+
+    if (m_indexsort) {
+      // clang-format off
+      std::stable_sort(table.begin(), table.end(), [](const i3_workspace_t& ws1, const i3_workspace_t& ws2){
+          return ws1->index < ws2->index;
+      });
+      // clang-format on
+    }
+
+    m_workspaces = move(table);
+  }  // }}}
+
+  /**
+   * Rebuild the labels of the workspaces whose flag has changed
+   *
+   * @return true if any label was rebuilt
+   */
+  bool i3_module::update_labels() {  // {{{
+    bool changed{false};
+
+    for (auto&& ws : m_workspaces) {
+      if (m_pinworkspaces && ws->output != m_bar.monitor->name) {
+        continue;
+      }
+
+      auto flag = current_flag(*ws);
+
+      if (!ws->label || ws->flag != flag) {
+        ws->flag = flag;
+        ws->label = create_label(*ws);
+        changed = true;
+      }
+    }
+
+    return changed;
+  }  // }}}
+
+  /**
+   * Get the state flag of given workspace
+   */
+  i3_flag i3_module::current_flag(const i3_workspace& ws) const {  // {{{
+    if (ws.focused)
+      return i3_flag::WORKSPACE_FOCUSED;
+    else if (ws.urgent)
+      return i3_flag::WORKSPACE_URGENT;
+    else if (!ws.visible || ws.output != m_focused_output)
+      return i3_flag::WORKSPACE_UNFOCUSED;
+    else
+      return i3_flag::WORKSPACE_VISIBLE;
+  }  // }}}
+
+  /**
+   * Create the label used for given workspace in its current state
+   */
+  label_t i3_module::create_label(const i3_workspace& ws) const {  // {{{
+    string wsname{ws.name};
+
+    // Remove workspace numbers "0:"
+    if (m_strip_wsnumbers)
+      wsname.erase(0, string_util::find_nth(wsname, 0, ":", 1) + 1);
+
+    // Trim leading and trailing whitespace
+    wsname = string_util::trim(wsname, ' ');
+
+    // Cap at configured max length
+    if (m_wsname_maxlen > 0 && wsname.length() > m_wsname_maxlen)
+      wsname.erase(m_wsname_maxlen);
+
+    auto icon = m_icons->get(ws.name, DEFAULT_WS_ICON);
+    auto label = m_statelabels.find(ws.flag)->second->clone();
+
+    label->reset_tokens();
+    label->replace_token("%output%", ws.output);
+    label->replace_token("%name%", wsname);
+    label->replace_token("%icon%", icon->get());
+    label->replace_token("%index%", to_string(ws.index));
+
+    return label;
+  }  // }}}
+
+  /**
+   * Find cached workspace by name
+   */
+  i3_workspace* i3_module::find_workspace(const string& name) const {  // {{{
+    for (auto&& ws : m_workspaces) {
+      if (ws->name == name) {
+        return ws.get();
+      }
+    }
+    return nullptr;
+  }  // }}}
 }
 
 POLYBAR_NS_END
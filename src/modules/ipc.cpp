@@ -14,27 +14,49 @@ namespace modules {
   /**
    * Load user-defined ipc hooks and
    * create formatting tags
+   *
+   * Modules without hooks only display
+   * content pushed using set: messages
    */
   void ipc_module::setup() {
     size_t index = 0;
 
-    for (auto&& command : m_conf.get_list<string>(name(), "hook")) {
+    for (auto&& command : m_conf.get_list<string>(name(), "hook", {})) {
       m_hooks.emplace_back(new hook{name() + to_string(++index), command});
     }
 
-    if (m_hooks.empty()) {
-      throw module_error("No ipc hooks defined");
-    }
-
     m_actions[mousebtn::LEFT] = m_conf.get<string>(name(), "click-left", "");
     m_actions[mousebtn::MIDDLE] = m_conf.get<string>(name(), "click-middle", "");
     m_actions[mousebtn::RIGHT] = m_conf.get<string>(name(), "click-right", "");
     m_actions[mousebtn::SCROLL_UP] = m_conf.get<string>(name(), "scroll-up", "");
     m_actions[mousebtn::SCROLL_DOWN] = m_conf.get<string>(name(), "scroll-down", "");
 
+    m_debounce = chrono::milliseconds{m_conf.get<int>(name(), "debounce-ms", m_debounce.count())};
+
     m_formatter->add(DEFAULT_FORMAT, TAG_OUTPUT, {TAG_OUTPUT});
   }
 
+  /**
+   * Start the worker thread executing the hooks
+   */
+  void ipc_module::start() {
+    static_module::start();
+    m_mainthread = thread(&ipc_module::runner, this);
+  }
+
+  /**
+   * Terminate the running hook command and wake up the
+   * worker thread so that it notices the module stopped
+   */
+  void ipc_module::teardown() {
+    std::lock_guard<std::mutex> guard(m_hooklock);
+    if (m_command && m_command->is_running()) {
+      m_log.warn("%s: Stopping hook command", name());
+      m_command->terminate();
+    }
+    m_hookcond.notify_all();
+  }
+
   /**
    * Wrap the output with defined mouse actions
    */
@@ -69,29 +91,135 @@ namespace modules {
   /**
    * Map received message hook to the ones
    * configured from the user config and
-   * execute its command
+   * queue its command for execution
+   *
+   * Multiple hooks can be sent in a single message by
+   * separating them with spaces, the last matching one wins
    */
   void ipc_module::on_message(const ipc_hook& message) {
-    bool match = false;
+    const hook* match{nullptr};
 
-    for (auto&& hook : m_hooks) {
-      if (ipc_hook::prefix + hook->payload != message.payload) {
-        continue;
+    for (auto&& payload : string_util::split(message.payload.substr(strlen(ipc_hook::prefix)), ' ')) {
+      for (auto&& hook : m_hooks) {
+        if (hook->payload == payload) {
+          match = hook.get();
+        }
       }
+    }
 
-      match = true;
+    if (match == nullptr) {
+      return;
+    }
 
-      m_log.info("%s: Found matching hook (%s)", name(), hook->payload);
-      m_output.clear();
+    m_log.info("%s: Found matching hook (%s)", name(), match->payload);
 
-      auto command = command_util::make_command(hook->command);
-      command->exec(false);
-      command->tail([this](string line) { m_output = line; });
+    std::lock_guard<std::mutex> guard(m_hooklock);
+    if (m_pending != nullptr) {
+      m_log.trace("%s: Replacing pending hook (%s)", name(), m_pending->payload);
     }
+    m_pending = match;
+    m_push_pending = false;
+    m_hookcond.notify_one();
+  }
+
+  /**
+   * Use content pushed using set:<module>:<content>
+   * as output, replacing any pending hook
+   *
+   * @return false if the message targets another module
+   */
+  bool ipc_module::on_set(const ipc_set& message) {
+    auto target = message.payload.substr(strlen(ipc_set::prefix));
+    auto pos = target.find(':');
+    auto content = target.substr(pos + 1);
+    target.erase(pos);
 
-    if (match) {
-      broadcast();
+    if (target != name() && "module/" + target != name()) {
+      return false;
     }
+
+    m_log.trace("%s: Received content (%s)", name(), content);
+
+    std::lock_guard<std::mutex> guard(m_hooklock);
+    m_pending = nullptr;
+    m_pushed = move(content);
+    m_push_pending = true;
+    m_hookcond.notify_one();
+
+    return true;
+  }
+
+  /**
+   * Wait for queued hooks or pushed content and
+   * update the output accordingly
+   */
+  void ipc_module::runner() {
+    std::unique_lock<std::mutex> guard(m_hooklock);
+
+    while (running()) {
+      m_hookcond.wait(guard, [&] { return m_pending != nullptr || m_push_pending || !running(); });
+
+      // Give subsequent hooks a chance to replace the pending one
+      if (m_debounce.count() > 0) {
+        m_hookcond.wait_for(guard, m_debounce, [&] { return !running(); });
+      }
+
+      if (!running()) {
+        break;
+      }
+
+      if (m_push_pending) {
+        m_push_pending = false;
+        m_output = move(m_pushed);
+        guard.unlock();
+        broadcast();
+      } else {
+        auto hook = m_pending;
+        m_pending = nullptr;
+        guard.unlock();
+        execute(*hook);
+      }
+
+      guard.lock();
+    }
+  }
+
+  /**
+   * Execute hook command and use the
+   * last line of its output as content
+   */
+  void ipc_module::execute(const hook& hook) {
+    m_log.info("%s: Executing hook (%s)", name(), hook.payload);
+
+    string output;
+
+    try {
+      {
+        // Start the command under the lock so that
+        // teardown either sees it or it never runs
+        std::lock_guard<std::mutex> guard(m_hooklock);
+        if (!running()) {
+          return;
+        }
+        m_command = command_util::make_command(hook.command);
+        m_command->exec(false);
+      }
+      m_command->tail([&output](string line) { output = line; });
+    } catch (const command_util::command_error& err) {
+      m_log.err("%s: Failed to execute hook command (%s)", name(), err.what());
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(m_hooklock);
+      m_command.reset();
+    }
+
+    if (!running()) {
+      return;
+    }
+
+    m_output = output;
+    broadcast();
   }
 }
 
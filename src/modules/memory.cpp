@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "modules/memory.hpp"
 
 #include "drawtypes/label.hpp"
@@ -12,9 +14,20 @@ namespace modules {
   template class module<memory_module>;
   template class timer_module<memory_module>;
 
+  namespace {
+    /**
+     * Fields read from /proc/meminfo, in the order
+     * their names are passed to the reader
+     */
+    enum meminfo_field { MEM_TOTAL = 0, MEM_FREE, MEM_AVAILABLE, BUFFERS, CACHED, SWAP_TOTAL, SWAP_FREE };
+  }
+
   void memory_module::setup() {
     m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 1));
 
+    m_meminfo = make_unique<file_util::field_reader>(PATH_MEMORY_INFO,
+        vector<string>{"MemTotal", "MemFree", "MemAvailable", "Buffers", "Cached", "SwapTotal", "SwapFree"});
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_USED, TAG_BAR_FREE});
 
     if (m_formatter->has(TAG_BAR_USED))
@@ -26,35 +39,27 @@ namespace modules {
   }
 
   bool memory_module::update() {
-    float kb_total;
-    float kb_avail;
-    // long kb_free;
-
-    try {
-      std::ifstream in(PATH_MEMORY_INFO);
-      std::stringstream buffer;
-      string str, rdbuf;
-      int i = 0;
-
-      in.exceptions(in.failbit);
-
-      buffer.imbue(std::locale::classic());
-
-      while (std::getline(in, str) && i++ < 3) {
-        size_t off = str.find_first_of("1234567890", str.find(':'));
-        buffer << std::strtol(&str[off], 0, 10) << std::endl;
-      }
-
-      buffer >> rdbuf;
-      kb_total = std::atol(rdbuf.c_str());
-      buffer >> rdbuf;  // kb_free = std::atol(rdbuf.c_str());
-      buffer >> rdbuf;
-      kb_avail = std::atol(rdbuf.c_str());
-    } catch (const std::ios_base::failure& e) {
-      kb_total = 0;
-      // kb_free = 0;
-      kb_avail = 0;
-      m_log.err("Failed to read memory values (what: %s)", e.what());
+    float kb_total{0};
+    float kb_avail{0};
+    float kb_buffers{0};
+    float kb_cached{0};
+    float kb_swap_total{0};
+    float kb_swap_free{0};
+
+    if (m_meminfo->read()) {
+      kb_total = m_meminfo->get(MEM_TOTAL);
+      kb_buffers = m_meminfo->get(BUFFERS);
+      kb_cached = m_meminfo->get(CACHED);
+      kb_swap_total = m_meminfo->get(SWAP_TOTAL);
+      kb_swap_free = m_meminfo->get(SWAP_FREE);
+
+      // MemAvailable is missing on kernels older than 3.14
+      if (m_meminfo->has(MEM_AVAILABLE))
+        kb_avail = m_meminfo->get(MEM_AVAILABLE);
+      else
+        kb_avail = m_meminfo->get(MEM_FREE) + kb_buffers + kb_cached;
+    } else {
+      m_log.err("%s: Failed to read memory values (%s)", name(), strerror(errno));
     }
 
     if (kb_total > 0)
@@ -80,9 +85,22 @@ namespace modules {
       replace_unit(m_label, "%mb_used%", (kb_total - kb_avail) / 1024, "MB");
       replace_unit(m_label, "%mb_free%", kb_avail / 1024, "MB");
       replace_unit(m_label, "%mb_total%", kb_total / 1024, "MB");
+      replace_unit(m_label, "%gb_buffers%", kb_buffers / 1024 / 1024, "GB");
+      replace_unit(m_label, "%gb_cached%", kb_cached / 1024 / 1024, "GB");
+      replace_unit(m_label, "%mb_buffers%", kb_buffers / 1024, "MB");
+      replace_unit(m_label, "%mb_cached%", kb_cached / 1024, "MB");
+      replace_unit(m_label, "%gb_swap_used%", (kb_swap_total - kb_swap_free) / 1024 / 1024, "GB");
+      replace_unit(m_label, "%gb_swap_free%", kb_swap_free / 1024 / 1024, "GB");
+      replace_unit(m_label, "%gb_swap_total%", kb_swap_total / 1024 / 1024, "GB");
+      replace_unit(m_label, "%mb_swap_used%", (kb_swap_total - kb_swap_free) / 1024, "MB");
+      replace_unit(m_label, "%mb_swap_free%", kb_swap_free / 1024, "MB");
+      replace_unit(m_label, "%mb_swap_total%", kb_swap_total / 1024, "MB");
 
       m_label->replace_token("%percentage_used%", to_string(m_perc[memtype::USED]) + "%");
       m_label->replace_token("%percentage_free%", to_string(m_perc[memtype::FREE]) + "%");
+
+      auto swap_used = kb_swap_total > 0 ? static_cast<int>((1 - kb_swap_free / kb_swap_total) * 100.0f + 0.5f) : 0;
+      m_label->replace_token("%percentage_swap_used%", to_string(swap_used) + "%");
     }
 
     return true;
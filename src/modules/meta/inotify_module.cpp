@@ -78,8 +78,11 @@ namespace modules {
               }
             }
 
-            if (CAST_MOD(Impl)->on_event(event.get()))
-              CAST_MOD(Impl)->broadcast();
+            {
+              trace_util::span span{"module", "update", this->m_name};
+              if (this->m_stats.update.measure([&] { return CAST_MOD(Impl)->on_event(event.get()); }))
+                CAST_MOD(Impl)->broadcast();
+            }
 
             CAST_MOD(Impl)->idle();
 
@@ -1,8 +1,13 @@
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstring>
+
 #include "modules/mpd.hpp"
 
 #include "drawtypes/iconset.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
+#include "utils/io.hpp"
 
 #include "modules/meta/base.inl"
 #include "modules/meta/event_module.inl"
@@ -15,6 +20,12 @@ namespace modules {
   template class module<mpd_module>;
   template class event_module<mpd_module>;
 
+  mpd_module::~mpd_module() {
+    if (m_wakefd != -1) {
+      close(m_wakefd);
+    }
+  }
+
   void mpd_module::setup() {
     m_host = m_conf.get<string>(name(), "host", m_host);
     m_port = m_conf.get<unsigned int>(name(), "port", m_port);
@@ -69,7 +80,9 @@ namespace modules {
 
     // }}}
 
-    m_lastsync = chrono::system_clock::now();
+    if ((m_wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+      m_log.warn("%s: Failed to create wakeup handle (%s)", name(), strerror(errno));
+    }
 
     try {
       m_mpd = make_unique<mpdconnection>(m_log, m_host, m_port, m_pass);
@@ -81,19 +94,48 @@ namespace modules {
     }
   }
 
+  /**
+   * Interrupt the wait for idle events
+   */
   void mpd_module::teardown() {
-    m_mpd.reset();
+    uint64_t value{1};
+    if (m_wakefd != -1 && ::write(m_wakefd, &value, sizeof(value)) == -1) {
+      m_log.err("%s: Failed to interrupt idle wait", name());
+    }
   }
 
   inline bool mpd_module::connected() const {
     return m_mpd && m_mpd->connected();
   }
 
+  /**
+   * Block until the server reports a change or, while playing,
+   * until the displayed elapsed time is due to be updated
+   */
   void mpd_module::idle() {
-    if (connected())
-      sleep(80ms);
-    else {
+    if (!connected() || !m_status) {
       sleep(2s);
+      return;
+    }
+
+    int timeout{-1};
+
+    if ((m_label_time || m_bar_progress) && m_status->match_state(mpdstate::PLAYING)) {
+      auto step = std::max(1U, static_cast<unsigned>(m_synctime + 0.5f));
+      long remaining = (m_lastelapsed + step) * 1000L - static_cast<long>(m_status->get_elapsed_ms());
+      timeout = std::max(remaining, 0L) + 1;
+    }
+
+    // Without the wakeup handle, wake up regularly to notice when the module stops
+    if (m_wakefd == -1 && (timeout == -1 || timeout > 1000)) {
+      timeout = 1000;
+    }
+
+    try {
+      m_mpd->wait(timeout, m_wakefd);
+    } catch (const mpd_exception& err) {
+      m_log.err("%s: %s", name(), err.what());
+      m_mpd.reset();
     }
   }
 
@@ -109,8 +151,11 @@ namespace modules {
     try {
       if (!m_mpd)
         m_mpd = make_unique<mpdconnection>(m_log, m_host, m_port, m_pass);
-      if (!connected())
+      if (!connected()) {
         m_mpd->connect();
+        m_status.reset();
+        m_refresh = true;
+      }
     } catch (const mpd_exception& err) {
       m_log.trace("%s: %s", name(), err.what());
       m_mpd.reset();
@@ -122,20 +167,19 @@ namespace modules {
 
     if (!m_status)
       m_status = m_mpd->get_status_safe();
+    if (!m_status)
+      return def;
 
     try {
-      m_mpd->idle();
-
       int idle_flags = 0;
 
-      if ((idle_flags = m_mpd->noidle()) != 0) {
+      // Only collect the idle events once the server has reported them,
+      // the elapsed time is interpolated locally in the meantime
+      if (io_util::poll_read(m_mpd->get_fd(), 0) && (idle_flags = m_mpd->noidle()) != 0) {
         m_status->update(idle_flags, m_mpd.get());
+        m_refresh = true;
         return true;
       }
-
-      if (m_status->match_state(mpdstate::PLAYING)) {
-        m_status->update_timer();
-      }
     } catch (const mpd_exception& err) {
       m_log.err(err.what());
       m_mpd.reset();
@@ -143,11 +187,12 @@ namespace modules {
     }
 
     if ((m_label_time || m_bar_progress) && m_status->match_state(mpdstate::PLAYING)) {
-      auto now = chrono::system_clock::now();
-      auto diff = now - m_lastsync;
+      m_status->update_timer();
 
-      if (chrono::duration_cast<chrono::milliseconds>(diff).count() > m_synctime * 1000) {
-        m_lastsync = now;
+      auto elapsed = m_status->get_elapsed_time();
+      auto step = std::max(1U, static_cast<unsigned>(m_synctime + 0.5f));
+
+      if (elapsed >= m_lastelapsed + step || elapsed < m_lastelapsed) {
         return true;
       }
     }
@@ -169,39 +214,45 @@ namespace modules {
       }
     }
 
-    string artist;
-    string album;
-    string title;
     string elapsed_str;
     string total_str;
 
-    try {
-      if (m_status) {
-        elapsed_str = m_status->get_formatted_elapsed();
-        total_str = m_status->get_formatted_total();
-      }
-
-      if (m_mpd) {
-        auto song = m_mpd->get_song();
+    if (m_status) {
+      elapsed_str = m_status->get_formatted_elapsed();
+      total_str = m_status->get_formatted_total();
+      m_lastelapsed = m_status->get_elapsed_time();
+    }
 
-        if (song && song.get()) {
-          artist = song->get_artist();
-          album = song->get_album();
-          title = song->get_title();
+    // The current song is only fetched when the server reported a
+    // change, interrupting the idle mode and costing a round trip
+    if (m_refresh && m_label_song) {
+      string artist;
+      string album;
+      string title;
+
+      try {
+        if (m_mpd) {
+          auto song = m_mpd->get_song();
+
+          if (song && song.get()) {
+            artist = song->get_artist();
+            album = song->get_album();
+            title = song->get_title();
+          }
         }
+      } catch (const mpd_exception& err) {
+        m_log.err(err.what());
+        m_mpd.reset();
       }
-    } catch (const mpd_exception& err) {
-      m_log.err(err.what());
-      m_mpd.reset();
-    }
 
-    if (m_label_song) {
       m_label_song->reset_tokens();
       m_label_song->replace_token("%artist%", !artist.empty() ? artist : "untitled artist");
       m_label_song->replace_token("%album%", !album.empty() ? album : "untitled album");
       m_label_song->replace_token("%title%", !title.empty() ? title : "untitled track");
     }
 
+    m_refresh = false;
+
     if (m_label_time) {
       m_label_time->reset_tokens();
       m_label_time->replace_token("%elapsed%", elapsed_str);
@@ -69,16 +69,20 @@ namespace modules {
     // We only need to start the subthread if the packetloss animation is used
     if (m_animation_packetloss)
       m_threads.emplace_back(thread(&network_module::subthread_routine, this));
+
+    m_monitorthread = thread(&network_module::monitor_routine, this);
   }
 
   void network_module::teardown() {
+    if (m_monitorthread.joinable())
+      m_monitorthread.join();
+
     m_wireless.reset();
     m_wired.reset();
   }
 
   bool network_module::update() {
-    net::network* network = m_wireless ? static_cast<net::network*>(m_wireless.get())
-                                       : static_cast<net::network*>(m_wired.get());
+    auto network = adapter();
 
     if (!network->query(m_accumulate)) {
       m_log.warn("%s: Failed to query interface '%s'", name(), m_interface);
@@ -159,6 +163,31 @@ namespace modules {
     return true;
   }
 
+  net::network* network_module::adapter() const {
+    if (m_wireless)
+      return m_wireless.get();
+    return m_wired.get();
+  }
+
+  /**
+   * Wake up the module as soon as the link or address
+   * of the interface changes instead of waiting for
+   * the next interval
+   */
+  void network_module::monitor_routine() {
+    while (running()) {
+      try {
+        if (adapter()->wait_for_change(250)) {
+          m_log.trace("%s: Interface changed", name());
+          wakeup();
+        }
+      } catch (const std::exception& err) {
+        m_log.err("%s: %s", name(), err.what());
+        break;
+      }
+    }
+  }
+
   void network_module::subthread_routine() {
     const chrono::milliseconds framerate{m_animation_packetloss->framerate()};
     const auto dur = chrono::duration<double>(framerate);
@@ -9,6 +9,13 @@ namespace modules {
   template class module<script_module>;
   template class event_module<script_module>;
 
+  namespace {
+    /**
+     * Amount of script modules created, used to stagger their start
+     */
+    atomic<size_t> g_scripts{0};
+  }
+
   void script_module::setup() {
     m_formatter->add(DEFAULT_FORMAT, TAG_OUTPUT, {TAG_OUTPUT});
 
@@ -26,6 +33,30 @@ namespace modules {
     m_actions[mousebtn::SCROLL_DOWN] = m_conf.get<string>(name(), "scroll-down", "");
 
     m_interval = chrono::duration<double>{m_conf.get<float>(name(), "interval", m_tail ? 0.0f : 2.0f)};
+    m_mininterval = chrono::duration_cast<chrono::milliseconds>(
+        chrono::duration<double>{m_conf.get<float>(name(), "min-interval", 0.0f)});
+
+    // Run non tail commands inside one of the shared persistent
+    // shells instead of spawning a new shell for each update
+    m_persistent = !m_tail && m_conf.get<bool>(name(), "persistent-shell", false);
+    // Commands are only killed if the timeout has been configured
+    m_timeout = chrono::milliseconds{static_cast<long>(m_conf.get<float>(name(), "timeout", 0.0f) * 1000)};
+
+    if (m_persistent) {
+      m_shells = command_util::get_shell_pool(m_conf.get<size_t>("settings", "script-shells", 2));
+    }
+
+    // Limit the amount of commands being spawned at the same time
+    auto limit = m_conf.get<size_t>("settings", "script-spawn-limit", std::max(thread::hardware_concurrency(), 1U));
+    m_slots = factory_util::generic_singleton<concurrency_util::semaphore>(limit);
+
+    // Spread the first run of the script modules so that
+    // modules sharing the same interval don't all fork at once
+    auto step = chrono::milliseconds{m_conf.get<int>("settings", "script-stagger-ms", 50)};
+    auto interval = chrono::duration_cast<chrono::milliseconds>(m_interval);
+    if (!m_tail && interval.count() > 0) {
+      m_stagger = (step * g_scripts++) % interval;
+    }
   }
 
   void script_module::stop() {
@@ -33,6 +64,9 @@ namespace modules {
       m_log.warn("%s: Stopping shell command", name());
       m_command->terminate();
     }
+    if (m_shells) {
+      m_shells->interrupt(m_shell);
+    }
     wakeup();
     event_module::stop();
   }
@@ -65,9 +99,24 @@ namespace modules {
     if (!m_command)
       return false;
 
-    if ((m_output = m_command->readline()) == m_prev)
+    string line;
+    m_output = m_command->readline();
+
+    // Only use the latest of the lines that are already available
+    // and keep reading until the minimum interval has passed
+    auto deadline = m_lastbroadcast + m_mininterval;
+    while (true) {
+      auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+      if (!m_command->readline(line, std::max<int>(0, remaining.count())))
+        break;
+      m_output = move(line);
+    }
+
+    if (m_output == m_prev)
       return false;
 
+    m_lastbroadcast = chrono::steady_clock::now();
+
     m_prev = m_output;
 
     return true;
@@ -84,12 +133,62 @@ namespace modules {
         return false;
       }
 
+      if (m_counter == 0 && m_stagger.count() > 0) {
+        sleep(m_stagger);
+        if (!running())
+          return false;
+      }
+
       auto exec = string_util::replace_all(m_exec, "%counter%", to_string(++m_counter));
       m_log.trace("%s: Executing '%s'", name(), exec);
 
-      m_command = command_util::make_command(exec);
-      m_command->exec();
-      m_command->tail([&](string output) { m_output = output; });
+      if (m_persistent) {
+        // The pool already bounds the amount of running commands
+        try {
+          m_shells->run(exec, m_timeout, [&](string output) { m_output = output; }, &m_shell);
+        } catch (const command_util::command_error& err) {
+          // The shell has been replaced by the pool, keep
+          // the previous output and try again next interval
+          if (!running())
+            return false;
+          m_log.err("%s: %s", name(), err.what());
+          return false;
+        }
+      } else {
+        {
+          // Only hold a slot while spawning to limit bursts of forks
+          // (script-spawn-limit), a hung command must not keep the other
+          // modules waiting. Wait in short steps so that stopping the
+          // module isn't blocked
+          std::unique_lock<concurrency_util::semaphore> slot(*m_slots, std::defer_lock);
+          while (!slot.try_lock_for(chrono::milliseconds{100})) {
+            if (!running())
+              return false;
+          }
+
+          m_command = command_util::make_command(exec);
+          m_command->exec(false);
+        }
+
+        if (m_timeout.count() == 0) {
+          m_command->tail([&](string output) { m_output = output; });
+          m_command->wait();
+        } else {
+          // The timeout also covers commands that close their
+          // output but keep running afterwards
+          auto deadline = chrono::steady_clock::now() + m_timeout;
+          auto remaining = [&] {
+            return chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+          };
+
+          if (!m_command->tail([&](string output) { m_output = output; }, m_timeout) ||
+              !m_command->wait(std::max(remaining(), chrono::milliseconds{0}))) {
+            m_log.err("%s: Command timed out after %lims, terminating it", name(), m_timeout.count());
+            m_command->terminate();
+            return false;
+          }
+        }
+      }
     } catch (const std::exception& err) {
       m_log.err("%s: %s", name(), err.what());
       throw module_error("Failed to execute command, stopping module...");
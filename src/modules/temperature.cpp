@@ -24,6 +24,8 @@ namespace modules {
     if (!file_util::exists(m_path))
       throw module_error("The file '" + m_path + "' does not exist");
 
+    m_file = make_unique<file_util::pread_reader>(m_path, 32);
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_RAMP});
     m_formatter->add(FORMAT_WARN, TAG_LABEL_WARN, {TAG_LABEL_WARN, TAG_RAMP});
 
@@ -36,7 +38,12 @@ namespace modules {
   }
 
   bool temperature_module::update() {
-    m_temp = std::atoi(file_util::get_contents(m_path).c_str()) / 1000.0f + 0.5f;
+    auto contents = m_file->read();
+
+    if (contents == nullptr)
+      return false;
+
+    m_temp = std::atoi(contents) / 1000.0f + 0.5f;
     m_perc = math_util::cap(math_util::percentage(m_temp, 0, m_tempwarn), 0, 100);
 
     const auto replace_tokens = [&](label_t& label) {
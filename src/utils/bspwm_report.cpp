@@ -0,0 +1,119 @@
+#include <cstring>
+
+#include "config.hpp"
+#include "utils/bspwm_report.hpp"
+
+POLYBAR_NS
+
+namespace bspwm_util {
+  bool operator==(const desktop_state& a, const desktop_state& b) {
+    return a.flag == b.flag && a.name == b.name;
+  }
+
+  bool operator==(const monitor_state& a, const monitor_state& b) {
+    return a.name == b.name && a.focused == b.focused && a.desktops == b.desktops && a.layout == b.layout &&
+           a.state == b.state && a.flags == b.flags;
+  }
+
+  // report_reader {{{
+
+  /**
+   * Add received data to the buffer
+   *
+   * @return true if the data completed at least one report
+   */
+  bool report_reader::feed(const char* data, size_t length) {
+    m_buffer.append(data, length);
+
+    auto end = m_buffer.rfind('\n');
+    if (end == string::npos) {
+      // Drop garbage that will never be terminated
+      if (m_buffer.size() > BUFSIZ * 16) {
+        m_buffer.clear();
+      }
+      return false;
+    }
+
+    auto start = end > 0 ? m_buffer.rfind('\n', end - 1) : string::npos;
+    start = start == string::npos ? 0 : start + 1;
+
+    m_report.assign(m_buffer, start, end - start);
+    m_buffer.erase(0, end + 1);
+
+    return !m_report.empty();
+  }
+
+  /**
+   * Get the most recent complete report
+   */
+  const string& report_reader::report() const {
+    return m_report;
+  }
+
+  // }}}
+
+  /**
+   * Parse report into the state of each monitor
+   *
+   * @return false if the report is malformed
+   */
+  bool parse_report(const string& report, vector<monitor_state>& monitors) {
+    const size_t prefix_len{strlen(BSPWM_STATUS_PREFIX)};
+
+    monitors.clear();
+
+    if (report.compare(0, prefix_len, BSPWM_STATUS_PREFIX) != 0) {
+      return false;
+    }
+
+    for (size_t pos = prefix_len, end; pos < report.size(); pos = end + 1) {
+      if ((end = report.find(':', pos)) == string::npos) {
+        end = report.size();
+      }
+      if (end == pos) {
+        continue;
+      }
+
+      auto tag = report[pos];
+      auto value = pos + 1;
+      auto length = end - value;
+
+      if (tag == 'M' || tag == 'm') {
+        monitors.emplace_back();
+        monitors.back().name.assign(report, value, length);
+        monitors.back().focused = tag == 'M';
+        continue;
+      } else if (monitors.empty()) {
+        return false;
+      }
+
+      auto& monitor = monitors.back();
+
+      switch (tag) {
+        case 'F':
+        case 'f':
+        case 'O':
+        case 'o':
+        case 'U':
+        case 'u':
+          monitor.desktops.emplace_back(desktop_state{tag, report.substr(value, length)});
+          break;
+        case 'L':
+          monitor.layout = length ? report[value] : '\0';
+          break;
+        case 'T':
+          monitor.state = length ? report[value] : '\0';
+          break;
+        case 'G':
+          monitor.flags.assign(report, value, length);
+          break;
+        default:
+          break;
+      }
+    }
+
+    return true;
+  }
+}
+
+POLYBAR_NS_END
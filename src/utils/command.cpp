@@ -1,19 +1,45 @@
+#include <fcntl.h>
+#include <spawn.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <algorithm>
 #include <csignal>
 
 #include "utils/command.hpp"
 #include "utils/io.hpp"
 #include "utils/process.hpp"
+#include "utils/string.hpp"
 
 POLYBAR_NS
 
 namespace command_util {
-  command::command(const logger& logger, string cmd) : m_log(logger), m_cmd("/usr/bin/env\nsh\n-c\n" + cmd) {
-    if (pipe(m_stdin) != 0)
+  namespace {
+    /**
+     * Shell builtins that have no executable counterpart
+     */
+    const vector<string> shell_builtins{
+        ".", ":", "alias", "cd", "eval", "exec", "exit", "export", "read", "set", "shift", "source", "trap", "umask", "unset", "wait"};
+  }
+
+  command::command(const logger& logger, string cmd) : m_log(logger), m_cmd(cmd) {
+    if (pipe2(m_stdin, O_CLOEXEC) != 0)
       throw command_strerror("Failed to allocate input stream");
-    if (pipe(m_stdout) != 0)
+    if (pipe2(m_stdout, O_CLOEXEC) != 0)
       throw command_strerror("Failed to allocate output stream");
+
+    m_reader = make_unique<io_util::line_reader>(m_stdout[PIPE_READ]);
+
+    if (!needs_shell(m_cmd)) {
+      for (auto&& arg : string_util::split(string_util::replace_all(m_cmd, "\t", " "), ' ')) {
+        if (!arg.empty()) {
+          m_args.emplace_back(arg);
+        }
+      }
+    }
+
+    if (m_args.empty() || std::find(shell_builtins.begin(), shell_builtins.end(), m_args[0]) != shell_builtins.end()) {
+      m_args = {"sh", "-c", m_cmd};
+    }
   }
 
   command::~command() {
@@ -30,60 +56,112 @@ namespace command_util {
       close(m_stdout[PIPE_WRITE]);
   }
 
+  /**
+   * Check if the command uses any shell syntax
+   * and therefore has to be executed using `sh -c`
+   */
+  bool command::needs_shell(const string& cmd) {
+    return cmd.find_first_of("|&;<>()$`\\\"'*?[]#~={}!\n") != string::npos;
+  }
+
   /**
    * Execute the command
    */
   int command::exec(bool wait_for_completion) {
-    if ((m_forkpid = fork()) == -1)
-      throw system_error("Failed to fork process");
-
-    if (process_util::in_forked_process(m_forkpid)) {
-      if (dup2(m_stdin[PIPE_READ], STDIN_FILENO) == -1)
-        throw command_strerror("Failed to redirect stdin in child process");
-      if (dup2(m_stdout[PIPE_WRITE], STDOUT_FILENO) == -1)
-        throw command_strerror("Failed to redirect stdout in child process");
-      if (dup2(m_stdout[PIPE_WRITE], STDERR_FILENO) == -1)
-        throw command_strerror("Failed to redirect stderr in child process");
-
-      // Close file descriptors that won't be used by the child
-      if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1)
-        throw command_strerror("Failed to close fd");
-      if ((m_stdin[PIPE_WRITE] = close(m_stdin[PIPE_WRITE])) == -1)
-        throw command_strerror("Failed to close fd");
-      if ((m_stdout[PIPE_READ] = close(m_stdout[PIPE_READ])) == -1)
-        throw command_strerror("Failed to close fd");
-      if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1)
-        throw command_strerror("Failed to close fd");
-
-      // Make sure SIGTERM is raised
-      process_util::unblock_signal(SIGTERM);
-
-      setpgid(m_forkpid, 0);
-      process_util::exec(m_cmd);
-
-      throw command_error("Exec failed");
-    } else {
-      // Close file descriptors that won't be used by the parent
-      if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1)
-        throw command_strerror("Failed to close fd");
-      if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1)
-        throw command_strerror("Failed to close fd");
-
-      if (wait_for_completion) {
-        auto status = wait();
-        m_forkpid = -1;
-        return status;
-      }
+    try {
+      spawn(m_args);
+    } catch (const system_error& err) {
+      // Let the shell report commands that can't be found
+      if (err.m_code != ENOENT || m_args[0] == "sh")
+        throw;
+      m_log.trace("command: %s, retrying using the shell", err.what());
+      m_args = {"sh", "-c", m_cmd};
+      spawn(m_args);
+    }
+
+    // Close file descriptors that won't be used by the parent
+    if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1)
+      throw command_strerror("Failed to close fd");
+    if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1)
+      throw command_strerror("Failed to close fd");
+
+    if (wait_for_completion) {
+      auto status = wait();
+      m_forkpid = -1;
+      return status;
     }
 
     return EXIT_SUCCESS;
   }
 
-  void command::terminate() {
+  /**
+   * Spawn the child process with its stdin and
+   * stdout/stderr connected to the pipes
+   *
+   * The child gets its own process group and an
+   * empty signal mask, since the signals handled by
+   * the controller are blocked in all our threads
+   */
+  void command::spawn(const vector<string>& args) {
+    vector<char*> argv;
+    for (auto&& arg : args) {
+      argv.emplace_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.emplace_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigmask;
+    sigset_t sigdefault;
+
+    sigemptyset(&sigmask);
+    sigemptyset(&sigdefault);
+    sigaddset(&sigdefault, SIGPIPE);
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, m_stdin[PIPE_READ], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, m_stdout[PIPE_WRITE], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, m_stdout[PIPE_WRITE], STDERR_FILENO);
+
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setsigmask(&attr, &sigmask);
+    posix_spawnattr_setsigdefault(&attr, &sigdefault);
+
+    int err = posix_spawnp(&m_forkpid, argv[0], &actions, &attr, argv.data(), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (err != 0) {
+      m_forkpid = -1;
+      errno = err;
+      throw system_error("Failed to execute " + args[0]);
+    }
+  }
+
+  /**
+   * Send SIGTERM to the process group of the child and
+   * escalate to SIGKILL if it's still running once the
+   * grace period has passed
+   */
+  void command::terminate(std::chrono::milliseconds grace) {
     try {
       if (is_running()) {
         m_log.trace("command: Sending SIGTERM to running child process (%d)", m_forkpid);
         killpg(m_forkpid, SIGTERM);
+
+        auto deadline = std::chrono::steady_clock::now() + grace;
+        while (is_running() && std::chrono::steady_clock::now() < deadline) {
+          this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+
+        if (is_running()) {
+          m_log.warn("command: Child process (%d) ignored SIGTERM, sending SIGKILL", m_forkpid);
+          killpg(m_forkpid, SIGKILL);
+        }
+
         wait();
       }
     } catch (const command_error& err) {
@@ -94,11 +172,15 @@ namespace command_util {
   }
 
   /**
-   * Check if command is running
+   * Check if command is running, reaps the child if it has exited
+   * so that its pid is never used again once it may have been reused
    */
   bool command::is_running() {
-    if (m_forkpid > 0)
-      return process_util::wait_for_completion_nohang(m_forkpid, &m_forkstatus) > -1;
+    if (m_forkpid <= 0)
+      return false;
+    if (process_util::wait_for_completion_nohang(m_forkpid, &m_forkstatus) == 0)
+      return true;
+    m_forkpid = -1;
     return false;
   }
 
@@ -106,6 +188,9 @@ namespace command_util {
    * Wait for the child processs to finish
    */
   int command::wait() {
+    if (m_forkpid <= 0)
+      return m_forkstatus;
+
     do {
       m_log.trace("command: Waiting for pid %d to finish...", m_forkpid);
 
@@ -125,9 +210,26 @@ namespace command_util {
         break;
     } while (!WIFEXITED(m_forkstatus) && !WIFSIGNALED(m_forkstatus));
 
+    m_forkpid = -1;
     return m_forkstatus;
   }
 
+  /**
+   * Wait for the child process to finish or the timeout to expire
+   *
+   * @return false if the command is still running
+   */
+  bool command::wait(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (is_running()) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    return true;
+  }
+
   /**
    * Tail command output
    *
@@ -135,7 +237,40 @@ namespace command_util {
    * end until the stream is closed
    */
   void command::tail(callback<string> callback) {
-    io_util::tail(m_stdout[PIPE_READ], callback);
+    string line;
+    while (m_reader->readline(line)) {
+      callback(line);
+    }
+  }
+
+  /**
+   * Tail command output until the stream is closed
+   * or the timeout expires
+   *
+   * @return false if the command timed out
+   */
+  bool command::tail(callback<string> callback, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    string line;
+
+    while (true) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+      if (m_reader->readline(line, std::max<int>(0, remaining.count()))) {
+        callback(line);
+      } else {
+        return !m_reader->timed_out();
+      }
+    }
+  }
+
+  /**
+   * Check if the last timed read gave up
+   * because no data arrived before the timeout
+   */
+  bool command::timed_out() {
+    std::lock_guard<concurrency_util::spin_lock> lck(m_pipelock);
+    return m_reader->timed_out();
   }
 
   /**
@@ -151,7 +286,18 @@ namespace command_util {
    */
   string command::readline() {
     std::lock_guard<concurrency_util::spin_lock> lck(m_pipelock);
-    return io_util::readline(m_stdout[PIPE_READ]);
+    string line;
+    m_reader->readline(line);
+    return line;
+  }
+
+  /**
+   * Read a line from the commands output stream,
+   * waiting at most the given time for data
+   */
+  bool command::readline(string& line, int timeout_ms) {
+    std::lock_guard<concurrency_util::spin_lock> lck(m_pipelock);
+    return m_reader->readline(line, timeout_ms);
   }
 
   /**
@@ -181,6 +327,196 @@ namespace command_util {
   int command::get_exit_status() {
     return m_forkstatus;
   }
+
+  // shell {{{
+
+  shell::shell(const logger& logger) : m_log(logger), m_command(make_command("sh")) {
+    m_marker = "#polybar-" + to_string(getpid()) + "-" +
+               to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "#";
+    m_command->exec(false);
+    m_log.trace("shell: Started persistent shell (pid=%d)", m_command->get_pid());
+  }
+
+  /**
+   * Execute command and pass each line of its output to the callback,
+   * a zero timeout waits for the command to finish
+   *
+   * @return Exit status of the command
+   * @throws command_error if the shell exited or the command timed out,
+   *         the shell can't be used anymore in both cases
+   */
+  int shell::run(const string& cmd, std::chrono::milliseconds timeout, const callback<string>& callback) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    // Pass the command quoted to eval so that a syntax error fails inside
+    // the subshell instead of leaving the shell waiting for more input
+    auto quoted = "'" + string_util::replace_all(cmd, "'", "'\\''") + "'";
+
+    if (m_command->writeline("( eval " + quoted + " ) </dev/null 2>&1; printf '%s %d\\n' '" + m_marker + "' \"$?\"") <= 0) {
+      throw command_error("Failed to write to shell");
+    }
+
+    string line;
+
+    while (true) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+      if (!m_command->readline(line, timeout.count() > 0 ? std::max<int>(0, remaining.count()) : -1)) {
+        // Don't reap the shell here, its pid has to stay valid
+        // until the pool stopped referring to it and killed it
+        if (m_interrupted) {
+          throw command_error("Command interrupted");
+        } else if (m_command->timed_out()) {
+          throw command_error("Command timed out");
+        }
+        throw command_error("Shell exited unexpectedly");
+      }
+
+      // The marker gets appended to the last line if it's not newline terminated
+      auto pos = line.find(m_marker);
+
+      if (pos == string::npos) {
+        callback(line);
+        continue;
+      } else if (pos > 0) {
+        callback(line.substr(0, pos));
+      }
+
+      return std::atoi(line.c_str() + pos + m_marker.size());
+    }
+  }
+
+  /**
+   * Kill the shell and all commands it's running without
+   * reaping it, making a pending run() fail right away
+   */
+  void shell::interrupt() {
+    auto pid = m_command->get_pid();
+    if (pid > 0) {
+      m_interrupted = true;
+      m_log.trace("shell: Interrupting persistent shell (pid=%d)", pid);
+      killpg(pid, SIGKILL);
+    }
+  }
+
+  /**
+   * Kill the shell and all commands it's running
+   */
+  void shell::kill() {
+    // The pid is only set while the shell hasn't been reaped,
+    // so the process group can't belong to another process
+    auto pid = m_command->get_pid();
+    if (pid > 0) {
+      m_log.trace("shell: Killing persistent shell (pid=%d)", pid);
+      killpg(pid, SIGKILL);
+      m_command->wait();
+    }
+  }
+
+  // }}}
+  // shell_pool {{{
+
+  /**
+   * Execute command using an idle shell, the command can
+   * be interrupted from another thread using the given handle
+   *
+   * @see shell::run
+   */
+  int shell_pool::run(
+      const string& cmd, std::chrono::milliseconds timeout, const callback<string>& callback, shell_handle* handle) {
+    auto sh = acquire(handle);
+
+    try {
+      auto status = sh->run(cmd, timeout, callback);
+      release(move(sh), handle);
+      return status;
+    } catch (const command_error& err) {
+      // Detach the shell before reaping it so that the
+      // handle never refers to a pid that has been reused
+      if (handle) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        handle->m_shell = nullptr;
+      }
+      sh->kill();
+      release(nullptr);
+      throw;
+    }
+  }
+
+  /**
+   * Kill the shell used by the handle, or make the next
+   * run using it fail if it isn't running any command
+   */
+  void shell_pool::interrupt(shell_handle& handle) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    handle.m_interrupted = true;
+    if (handle.m_shell) {
+      handle.m_shell->interrupt();
+    }
+    m_cond.notify_all();
+  }
+
+  /**
+   * Take an idle shell from the pool, waiting for one
+   * to become available if all of them are in use
+   */
+  unique_ptr<shell> shell_pool::acquire(shell_handle* handle) {
+    std::unique_lock<std::mutex> guard(m_mutex);
+    auto interrupted = [&] { return handle && handle->m_interrupted; };
+    m_cond.wait(guard, [&] { return interrupted() || !m_idle.empty() || m_spawned < m_size; });
+
+    if (interrupted()) {
+      throw command_error("Command interrupted");
+    }
+
+    unique_ptr<shell> sh;
+
+    if (!m_idle.empty()) {
+      sh = move(m_idle.back());
+      m_idle.pop_back();
+    } else {
+      m_spawned++;
+      guard.unlock();
+
+      try {
+        sh = make_unique<shell>(m_log);
+      } catch (const application_error& err) {
+        release(nullptr);
+        throw;
+      }
+
+      guard.lock();
+    }
+
+    if (interrupted()) {
+      guard.unlock();
+      release(move(sh));
+      throw command_error("Command interrupted");
+    } else if (handle) {
+      handle->m_shell = sh.get();
+    }
+
+    return sh;
+  }
+
+  /**
+   * Return shell to the pool, a null shell
+   * frees the slot of a discarded one
+   */
+  void shell_pool::release(unique_ptr<shell>&& sh, shell_handle* handle) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (handle) {
+      handle->m_shell = nullptr;
+    }
+    if (sh) {
+      m_idle.emplace_back(forward<decltype(sh)>(sh));
+    } else {
+      m_spawned--;
+    }
+    m_cond.notify_one();
+  }
+
+  // }}}
 }
 
 POLYBAR_NS_END
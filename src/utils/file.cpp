@@ -3,6 +3,8 @@
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
 #include <fstream>
 #include "utils/scope.hpp"
 
@@ -31,6 +33,143 @@ namespace file_util {
     return m_ptr;
   }
 
+  /**
+   * Open the given file for reading
+   *
+   * @throws system_error if the file can't be opened
+   */
+  pread_reader::pread_reader(const string& path, size_t size) : m_path(path), m_buffer(size) {
+    if ((m_fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC)) == -1) {
+      throw system_error("Failed to open " + m_path);
+    }
+  }
+
+  pread_reader::~pread_reader() {
+    if (m_fd != -1) {
+      close(m_fd);
+    }
+  }
+
+  /**
+   * Read the whole file, growing the buffer if it doesn't fit
+   *
+   * @return Null terminated contents that stay valid until
+   *         the next call, or nullptr if the read failed
+   */
+  const char* pread_reader::read(size_t* length) {
+    size_t bytes{0};
+
+    while (true) {
+      auto n = pread(m_fd, m_buffer.data() + bytes, m_buffer.size() - bytes, bytes);
+
+      if (n == -1 && errno == EINTR) {
+        continue;
+      } else if (n == -1) {
+        return nullptr;
+      } else if (n == 0) {
+        break;
+      }
+
+      bytes += n;
+
+      if (bytes == m_buffer.size()) {
+        m_buffer.resize(m_buffer.size() * 2);
+      }
+    }
+
+    m_buffer[bytes] = '\0';
+
+    if (length != nullptr) {
+      *length = bytes;
+    }
+
+    return m_buffer.data();
+  }
+
+  /**
+   * Open the given file for reading the given fields
+   */
+  field_reader::field_reader(const string& path, vector<string> keys)
+      : pread_reader(path)
+      , m_keys(move(keys))
+      , m_offsets(m_keys.size(), string::npos)
+      , m_values(m_keys.size())
+      , m_found(m_keys.size()) {}
+
+  /**
+   * Reread the file and parse the requested fields
+   *
+   * @return false if the file couldn't be read
+   */
+  bool field_reader::read() {
+    size_t length{0};
+    auto contents = pread_reader::read(&length);
+
+    if (contents == nullptr) {
+      return false;
+    }
+
+    for (size_t i = 0; i < m_keys.size(); i++) {
+      auto& key = m_keys[i];
+      auto offset = m_offsets[i];
+
+      if (offset == string::npos || offset + key.size() >= length || (offset > 0 && contents[offset - 1] != '\n') ||
+          strncmp(contents + offset, key.c_str(), key.size()) != 0 ||
+          (contents[offset + key.size()] != ':' && contents[offset + key.size()] != ' ')) {
+        offset = m_offsets[i] = find(contents, length, key);
+      }
+
+      if ((m_found[i] = offset != string::npos)) {
+        auto pos = contents + offset + key.size() + 1;
+        while (*pos == ' ' || *pos == '\t') {
+          pos++;
+        }
+        m_values[i] = 0;
+        while (*pos >= '0' && *pos <= '9') {
+          m_values[i] = m_values[i] * 10 + (*pos++ - '0');
+        }
+      } else {
+        m_values[i] = 0;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Get value of the field with the given index, zero if missing
+   */
+  unsigned long long field_reader::get(size_t index) const {
+    return m_values[index];
+  }
+
+  /**
+   * Check if the field with the given index was found
+   */
+  bool field_reader::has(size_t index) const {
+    return m_found[index];
+  }
+
+  /**
+   * Find the offset of the line starting with the given key
+   */
+  size_t field_reader::find(const char* contents, size_t length, const string& key) const {
+    for (size_t offset = 0; offset + key.size() < length;) {
+      if (strncmp(contents + offset, key.c_str(), key.size()) == 0 &&
+          (contents[offset + key.size()] == ':' || contents[offset + key.size()] == ' ')) {
+        return offset;
+      }
+
+      auto next = static_cast<const char*>(memchr(contents + offset, '\n', length - offset));
+      if (next == nullptr) {
+        break;
+      }
+      offset = next - contents + 1;
+    }
+
+    return string::npos;
+  }
+
   /**
    * Checks if the given file exist
    */
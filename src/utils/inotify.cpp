@@ -17,11 +17,17 @@ namespace inotify_util {
   }
 
   /**
-   * Attach inotify watch
+   * Attach inotify watch, replacing the previous watch
+   * since the path may now refer to another file
    */
   void inotify_watch::attach(int mask) {
     if (m_fd == -1 && (m_fd = inotify_init()) == -1)
       throw system_error("Failed to allocate inotify fd");
+    if (m_wd != -1) {
+      // The watch is gone already if the file has been deleted
+      inotify_rm_watch(m_fd, m_wd);
+      m_wd = -1;
+    }
     if ((m_wd = inotify_add_watch(m_fd, m_path.c_str(), mask)) == -1)
       throw system_error("Failed to attach inotify watch");
   }
@@ -112,6 +112,94 @@ namespace io_util {
     size_t bytes = ::write(write_fd, end, 1);
     return bytes > 0;
   }
+
+  // line_reader {{{
+
+  /**
+   * Read next line, blocking until a complete line
+   * is available or the end of the stream is reached
+   *
+   * Lines are terminated by a newline or a null byte,
+   * a trailing unterminated line is returned at eof
+   *
+   * @param timeout_ms Max time to wait for each chunk of data, -1 to block
+   * @return false if there are no more lines to read or if waiting timed out
+   */
+  bool line_reader::readline(string& line, int timeout_ms) {
+    m_timedout = false;
+
+    while (true) {
+      auto end = m_buffer.find_first_of(string{"\n\0", 2}, m_offset);
+
+      if (end != string::npos) {
+        line.assign(m_buffer, m_offset, end - m_offset);
+        m_offset = end + 1;
+        return true;
+      } else if (m_eof || !fill(timeout_ms)) {
+        break;
+      }
+    }
+
+    if (m_timedout) {
+      return false;
+    }
+
+    if (m_offset < m_buffer.size()) {
+      line.assign(m_buffer, m_offset, string::npos);
+      m_buffer.clear();
+      m_offset = 0;
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Check if there is unconsumed data in the buffer
+   */
+  bool line_reader::buffered() const {
+    return m_offset < m_buffer.size();
+  }
+
+  /**
+   * Check if the last readline call gave up waiting for data
+   */
+  bool line_reader::timed_out() const {
+    return m_timedout;
+  }
+
+  /**
+   * Append the next chunk of data to the buffer
+   *
+   * @return false at eof, on read errors or timeout
+   */
+  bool line_reader::fill(int timeout_ms) {
+    if (m_offset > 0) {
+      m_buffer.erase(0, m_offset);
+      m_offset = 0;
+    }
+
+    if (timeout_ms >= 0 && !poll(m_fd, POLLIN | POLLHUP, timeout_ms)) {
+      m_timedout = true;
+      return false;
+    }
+
+    char data[BUFSIZ];
+    ssize_t bytes;
+
+    while ((bytes = ::read(m_fd, data, sizeof(data))) == -1 && errno == EINTR) {
+    }
+
+    if (bytes <= 0) {
+      m_eof = true;
+      return false;
+    }
+
+    m_buffer.append(data, bytes);
+    return true;
+  }
+
+  // }}}
 }
 
 POLYBAR_NS_END
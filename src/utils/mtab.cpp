@@ -0,0 +1,109 @@
+#include <poll.h>
+#include <cstring>
+
+#include "utils/mtab.hpp"
+
+POLYBAR_NS
+
+namespace mtab_util {
+  namespace {
+    /**
+     * Get the next space separated field and decode the
+     * octal escapes used for spaces, tabs and newlines
+     */
+    string next_field(const char*& pos) {
+      string field;
+
+      while (*pos == ' ') {
+        pos++;
+      }
+
+      for (; *pos != '\0' && *pos != ' ' && *pos != '\n'; pos++) {
+        if (pos[0] == '\\' && pos[1] >= '0' && pos[1] <= '3' && pos[2] >= '0' && pos[2] <= '7' && pos[3] >= '0' &&
+            pos[3] <= '7') {
+          field += static_cast<char>((pos[1] - '0') << 6 | (pos[2] - '0') << 3 | (pos[3] - '0'));
+          pos += 3;
+        } else {
+          field += *pos;
+        }
+      }
+
+      return field;
+    }
+  }
+
+  /**
+   * Look up the entry mounted at the given path, parsing
+   * the table again if it changed since the last lookup
+   *
+   * @return false if nothing is mounted at the path
+   */
+  bool mountinfo::find(const string& mountpoint, mount_entry& entry) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    if (!m_parsed || changed()) {
+      auto contents = read();
+      if (contents == nullptr) {
+        throw system_error("Failed to read " + m_path);
+      }
+      parse(contents);
+      m_parsed = true;
+    }
+
+    auto it = m_mounts.find(mountpoint);
+    if (it == m_mounts.end()) {
+      return false;
+    }
+
+    entry = it->second;
+    return true;
+  }
+
+  /**
+   * Check if the kernel flagged the table as changed
+   */
+  bool mountinfo::changed() const {
+    struct pollfd fds[1];
+    fds[0].fd = m_fd;
+    fds[0].events = POLLPRI;
+    return ::poll(fds, 1, 0) > 0 && (fds[0].revents & POLLPRI);
+  }
+
+  /**
+   * Parse the lines of mountinfo, formatted as
+   * "id parent major:minor root mountpoint options [optional...] - type source superoptions",
+   * entries mounted later on top of the same path replace the earlier ones
+   */
+  void mountinfo::parse(const char* contents) {
+    m_mounts.clear();
+
+    for (auto pos = contents; *pos != '\0';) {
+      for (int i = 0; i < 4; i++) {
+        next_field(pos);
+      }
+
+      mount_entry entry;
+      entry.mountpoint = next_field(pos);
+
+      // skip options and the optional fields until the separator
+      for (string field; *pos != '\0' && *pos != '\n';) {
+        if ((field = next_field(pos)) == "-") {
+          entry.type = next_field(pos);
+          entry.fsname = next_field(pos);
+          break;
+        }
+      }
+
+      if (!entry.mountpoint.empty()) {
+        m_mounts[entry.mountpoint] = move(entry);
+      }
+
+      if ((pos = strchr(pos, '\n')) == nullptr) {
+        break;
+      }
+      pos++;
+    }
+  }
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,93 @@
+#include <ostream>
+
+#include "utils/stats.hpp"
+#include "utils/string.hpp"
+
+POLYBAR_NS
+
+namespace stats_util {
+  counter frames_rendered{0};
+  counter frames_skipped{0};
+  counter x_connection_requests{0};
+
+  // histogram {{{
+
+  /**
+   * Add sample to the matching bucket
+   */
+  void histogram::record(uint64_t usec) {
+    size_t bucket{0};
+    while (usec >> bucket && bucket < BUCKETS - 1) {
+      bucket++;
+    }
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(usec, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get amount of recorded samples
+   */
+  uint64_t histogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get sum of all recorded samples in microseconds
+   */
+  uint64_t histogram::total() const {
+    return m_total.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Get amount of samples recorded in given bucket
+   */
+  uint64_t histogram::bucket(size_t index) const {
+    return m_buckets.at(index).load(std::memory_order_relaxed);
+  }
+
+  void histogram::write_json(std::ostream& out) const {
+    out << "{\"count\":" << count() << ",\"total_us\":" << total() << ",\"buckets\":[";
+    for (size_t i = 0; i < BUCKETS; i++) {
+      out << (i > 0 ? "," : "") << m_buckets[i].load(std::memory_order_relaxed);
+    }
+    out << "]}";
+  }
+
+  // }}}
+  // module_counters {{{
+
+  void module_counters::write_json(std::ostream& out) const {
+    out << "{\"updates\":" << update.count();
+    out << ",\"update\":";
+    update.write_json(out);
+    out << ",\"get_output\":";
+    output.write_json(out);
+    out << ",\"output_bytes\":" << output_bytes;
+    out << ",\"broadcasts\":" << broadcasts;
+    out << ",\"unchanged_broadcasts\":" << unchanged << "}";
+  }
+
+  // }}}
+
+  /**
+   * Write the process wide counters and the
+   * counters of the given modules as json
+   */
+  void write_json(std::ostream& out, const vector<pair<string, const module_counters*>>& modules) {
+    out << "{\"frames_rendered\":" << frames_rendered;
+    out << ",\"frames_skipped\":" << frames_skipped;
+    out << ",\"x_connection_requests\":" << x_connection_requests;
+    out << ",\"modules\":{";
+
+    size_t n{0};
+    for (auto&& module : modules) {
+      out << (n++ > 0 ? "," : "") << "\"" << string_util::escape_json(module.first) << "\":";
+      module.second->write_json(out);
+    }
+
+    out << "}}\n";
+  }
+}
+
+POLYBAR_NS_END
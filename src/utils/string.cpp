@@ -121,6 +121,24 @@ namespace string_util {
     return str;
   }
 
+  /**
+   * Escape string for use inside a quoted json string,
+   * control characters are dropped
+   */
+  string escape_json(const string& haystack) {
+    string str;
+    str.reserve(haystack.size());
+    for (auto&& c : haystack) {
+      if (c == '"' || c == '\\') {
+        str += '\\';
+        str += c;
+      } else if (static_cast<unsigned char>(c) >= 0x20) {
+        str += c;
+      }
+    }
+    return str;
+  }
+
   /**
    * Remove needle from the start of the string
    */
@@ -0,0 +1,106 @@
+#include "utils/time.hpp"
+
+POLYBAR_NS
+
+namespace time_util {
+  namespace {
+    /**
+     * Conversions whose output changes every second
+     */
+    constexpr auto SECOND_CONVERSIONS = "STrsXc+";
+
+    constexpr auto FLAG_CHARACTERS = "_-0^#";
+  }
+
+  // formatter {{{
+
+  /**
+   * Split the format into static text and conversion
+   * specifications, including their flags, width and
+   * E/O modifiers
+   */
+  formatter::formatter(const string& format) {
+    string text;
+
+    for (size_t i = 0; i < format.size(); i++) {
+      if (format[i] != '%' || i + 1 == format.size()) {
+        text += format[i];
+        continue;
+      } else if (format[i + 1] == '%') {
+        text += '%';
+        i++;
+        continue;
+      }
+
+      size_t end = i + 1;
+      while (end < format.size() && string{FLAG_CHARACTERS}.find(format[end]) != string::npos) {
+        end++;
+      }
+      while (end < format.size() && isdigit(format[end])) {
+        end++;
+      }
+      if (end < format.size() && (format[end] == 'E' || format[end] == 'O')) {
+        end++;
+      }
+      if (end == format.size()) {
+        text += format.substr(i);
+        break;
+      }
+
+      if (!text.empty()) {
+        m_fields.emplace_back(field{text, false, false, text});
+        text.clear();
+      }
+
+      bool seconds{string{SECOND_CONVERSIONS}.find(format[end]) != string::npos};
+      m_fields.emplace_back(field{format.substr(i, end - i + 1), true, seconds, ""});
+      i = end;
+    }
+
+    if (!text.empty()) {
+      m_fields.emplace_back(field{text, false, false, text});
+    }
+  }
+
+  /**
+   * Format the given timestamp in local time
+   */
+  const string& formatter::format(std::time_t time) {
+    bool minute_changed{time < m_minute || time >= m_minute + 60};
+
+    if (minute_changed) {
+      localtime_r(&time, &m_tm);
+      m_minute = time - m_tm.tm_sec;
+    } else {
+      m_tm.tm_sec = time - m_minute;
+    }
+
+    m_result.clear();
+
+    for (auto&& f : m_fields) {
+      if (f.dynamic && (minute_changed || f.seconds)) {
+        char buffer[128];
+        f.value.assign(buffer, std::strftime(buffer, sizeof(buffer), f.spec.c_str(), &m_tm));
+      }
+      m_result += f.value;
+    }
+
+    return m_result;
+  }
+
+  /**
+   * Check if the format contains conversions that change every second
+   */
+  bool formatter::seconds() const {
+    for (auto&& f : m_fields) {
+      if (f.seconds) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // }}}
+}
+
+POLYBAR_NS_END
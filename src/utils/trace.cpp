@@ -0,0 +1,200 @@
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+#include "utils/string.hpp"
+#include "utils/trace.hpp"
+
+POLYBAR_NS
+
+namespace trace_util {
+  namespace {
+    stateflag g_enabled{false};
+
+    std::mutex g_mutex;
+    vector<shared_ptr<buffer>> g_buffers;
+
+    /**
+     * Drop the oldest buffers of exited threads
+     * once more than the allowed amount is kept
+     */
+    void prune_retired() {
+      size_t retired = std::count_if(
+          g_buffers.begin(), g_buffers.end(), [](const shared_ptr<buffer>& buf) { return buf->retired(); });
+
+      for (auto it = g_buffers.begin(); it != g_buffers.end() && retired > MAX_RETIRED_BUFFERS;) {
+        if ((*it)->retired()) {
+          it = g_buffers.erase(it);
+          retired--;
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    /**
+     * Owner of the calling thread's buffer, the buffer is
+     * flagged as retired once the thread exits so that its
+     * events can be dumped one last time before being dropped
+     */
+    struct thread_buffer {
+      shared_ptr<buffer> ptr;
+
+      ~thread_buffer() {
+        if (ptr) {
+          ptr->retire();
+          std::lock_guard<std::mutex> guard(g_mutex);
+          prune_retired();
+        }
+      }
+    };
+
+    thread_local thread_buffer t_buffer;
+
+    /**
+     * Get the buffer of the calling thread,
+     * allocating and registering it on first use
+     */
+    buffer& local_buffer() {
+      if (!t_buffer.ptr) {
+        t_buffer.ptr = make_shared<buffer>(syscall(SYS_gettid));
+        std::lock_guard<std::mutex> guard(g_mutex);
+        g_buffers.emplace_back(t_buffer.ptr);
+      }
+      return *t_buffer.ptr;
+    }
+  }
+
+  // buffer {{{
+
+  /**
+   * Add event, overwriting the oldest one if the buffer is full
+   */
+  void buffer::push(const event& evt) {
+    std::lock_guard<concurrency_util::spin_lock> guard(m_lock);
+    m_events[m_next] = evt;
+    m_next = (m_next + 1) % m_events.size();
+    m_count = std::min(m_count + 1, m_events.size());
+  }
+
+  /**
+   * Get a copy of the recorded events, oldest first
+   */
+  vector<event> buffer::events() {
+    std::lock_guard<concurrency_util::spin_lock> guard(m_lock);
+    vector<event> events;
+    events.reserve(m_count);
+    for (size_t i = (m_next + m_events.size() - m_count) % m_events.size(); events.size() < m_count;
+         i = (i + 1) % m_events.size()) {
+      events.emplace_back(m_events[i]);
+    }
+    return events;
+  }
+
+  long buffer::tid() const {
+    return m_tid;
+  }
+
+  void buffer::retire() {
+    m_retired = true;
+  }
+
+  bool buffer::retired() const {
+    return m_retired;
+  }
+
+  // }}}
+  // span {{{
+
+  span::span(const char* category, const char* name, const char* detail) {
+    if (!g_enabled) {
+      return;
+    }
+    m_active = true;
+    m_event.category = category;
+    if (detail != nullptr)
+      snprintf(m_event.name, sizeof(m_event.name), "%s %s", name, detail);
+    else
+      snprintf(m_event.name, sizeof(m_event.name), "%s", name);
+    m_event.start = now();
+  }
+
+  span::~span() {
+    if (m_active) {
+      m_event.duration = now() - m_event.start;
+      local_buffer().push(m_event);
+    }
+  }
+
+  // }}}
+
+  /**
+   * Start or stop recording events
+   */
+  void enable(bool state) {
+    g_enabled = state;
+  }
+
+  /**
+   * Check if events are being recorded
+   */
+  bool enabled() {
+    return g_enabled;
+  }
+
+  /**
+   * Get monotonic timestamp in microseconds
+   */
+  uint64_t now() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /**
+   * Write recorded events to given file
+   *
+   * @see dump(std::ostream&)
+   */
+  size_t dump(const string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+      throw system_error("Failed to open " + path);
+    }
+    return dump(out);
+  }
+
+  /**
+   * Write recorded events of all threads using the
+   * chrome trace event format (chrome://tracing)
+   *
+   * Buffers belonging to exited threads are
+   * released once they have been written
+   */
+  size_t dump(std::ostream& out) {
+    std::lock_guard<std::mutex> guard(g_mutex);
+    size_t count{0};
+    auto pid = getpid();
+
+    out << "{\"traceEvents\":[";
+
+    for (auto&& buf : g_buffers) {
+      for (auto&& evt : buf->events()) {
+        out << (count++ > 0 ? ",\n" : "\n") << "{\"name\":\"" << string_util::escape_json(evt.name);
+        out << "\",\"cat\":\"" << string_util::escape_json(evt.category);
+        out << "\",\"ph\":\"X\",\"ts\":" << evt.start << ",\"dur\":" << evt.duration;
+        out << ",\"pid\":" << pid << ",\"tid\":" << buf->tid() << "}";
+      }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    g_buffers.erase(std::remove_if(g_buffers.begin(), g_buffers.end(),
+                        [](const shared_ptr<buffer>& buf) { return buf->retired(); }),
+        g_buffers.end());
+
+    return count;
+  }
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,117 @@
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "utils/io.hpp"
+#include "utils/uevent.hpp"
+
+POLYBAR_NS
+
+namespace uevent_util {
+  /**
+   * Get value of the given environment key, empty if missing
+   */
+  string event::get(const string& key) const {
+    auto it = env.find(key);
+    return it != env.end() ? it->second : "";
+  }
+
+  /**
+   * Parse the null separated fields of a kernel uevent
+   *
+   * @return false if the data isn't a kernel uevent (e.g. one
+   *         rebroadcast by udev, starting with "libudev")
+   */
+  bool parse(const char* data, size_t length, event& evt) {
+    auto end = data + length;
+    auto header_end = static_cast<const char*>(memchr(data, '\0', length));
+    auto at = static_cast<const char*>(memchr(data, '@', length));
+
+    if (header_end == nullptr || at == nullptr || at > header_end) {
+      return false;
+    }
+
+    evt.action.assign(data, at);
+    evt.devpath.assign(at + 1, header_end);
+    evt.env.clear();
+
+    for (auto pos = header_end + 1; pos < end;) {
+      auto field_end = static_cast<const char*>(memchr(pos, '\0', end - pos));
+      if (field_end == nullptr) {
+        field_end = end;
+      }
+
+      auto eq = static_cast<const char*>(memchr(pos, '=', field_end - pos));
+      if (eq != nullptr) {
+        evt.env[string{pos, eq}] = string{eq + 1, field_end};
+      }
+
+      pos = field_end + 1;
+    }
+
+    return true;
+  }
+
+  // monitor {{{
+
+  /**
+   * Subscribe to kernel uevents
+   *
+   * @throws system_error if the socket can't be created
+   */
+  monitor::monitor(string subsystem) : m_subsystem(move(subsystem)) {
+    if ((m_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT)) == -1) {
+      throw system_error("Failed to open uevent socket");
+    }
+
+    struct sockaddr_nl addr {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1;
+
+    if (bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      close(m_fd);
+      throw system_error("Failed to bind uevent socket");
+    }
+  }
+
+  monitor::~monitor() {
+    if (m_fd != -1) {
+      close(m_fd);
+    }
+  }
+
+  /**
+   * Wait for uevents to become available
+   */
+  bool monitor::poll(int timeout_ms) {
+    return io_util::poll_read(m_fd, timeout_ms);
+  }
+
+  /**
+   * Get the next pending uevent of the subsystem without blocking
+   *
+   * @return false if there are no more pending events
+   */
+  bool monitor::receive(event& evt) {
+    char buffer[8192];
+    ssize_t bytes;
+
+    while ((bytes = recv(m_fd, buffer, sizeof(buffer), MSG_DONTWAIT)) != 0) {
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1) {
+        return false;
+      } else if (parse(buffer, bytes, evt) && evt.get("SUBSYSTEM") == m_subsystem) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // }}}
+}
+
+POLYBAR_NS_END
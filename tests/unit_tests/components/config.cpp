@@ -0,0 +1,137 @@
+#include <cstdlib>
+#include <fstream>
+
+#include "components/config.cpp"
+#include "components/logger.cpp"
+#include "utils/env.cpp"
+#include "utils/file.cpp"
+#include "utils/string.cpp"
+#include "x11/xlib.cpp"
+#include "x11/xresources.cpp"
+
+int main() {
+  using namespace polybar;
+
+  const logger& log = configure_logger().create<const logger&>();
+  const xresource_manager& xrm = configure_xresource_manager().create<const xresource_manager&>();
+
+  const string path{"/tmp/polybar_test_config." + to_string(getpid()) + ".ini"};
+
+  const auto write = [&](const string& contents) {
+    std::ofstream out(path, std::ios::trunc);
+    out << contents;
+  };
+
+  const auto load = [&](const string& contents) {
+    write(contents);
+    auto conf = make_unique<config>(log, xrm);
+    conf->load(path, "top");
+    return conf;
+  };
+
+  "list_indexing"_test = [&] {
+    auto conf = load(
+        "[bar/top]\n"
+        "full-0 = a\nfull-1 = b\nfull-2 = c\n"
+        "gap-0 = a\ngap-1 = b\ngap-3 = d\n"
+        "padded-0 = a\npadded-01 = b\npadded-1 = c\n"
+        "missing-1 = b\n");
+
+    expect(conf->get_list<string>("bar/top", "full") == vector<string>{"a", "b", "c"});
+    expect(conf->get_list<string>("bar/top", "gap") == vector<string>{"a", "b"});
+    expect(conf->get_list<string>("bar/top", "padded") == vector<string>{"a", "c"});
+    expect(conf->get_list<string>("bar/top", "missing", {}).empty());
+    expect(conf->get<string>("bar/top", "padded-01") == "b");
+  };
+
+  "local_references"_test = [&] {
+    auto conf = load(
+        "[bar/top]\n"
+        "height = 20\n"
+        "size = ${self.height}\n"
+        "[colors]\n"
+        "base = #fff\n"
+        "fg = ${colors.base}\n"
+        "[module/foo]\n"
+        "height = ${root.size}\n"
+        "color = ${colors.fg}\n"
+        "label = ${self.color}\n");
+
+    expect(conf->get<int>("bar/top", "size") == 20);
+    expect(conf->get<int>("module/foo", "height") == 20);
+    expect(conf->get<string>("module/foo", "color") == "#fff");
+    expect(conf->get<string>("module/foo", "label") == "#fff");
+  };
+
+  "reference_errors"_test = [&] {
+    auto conf = load(
+        "[bar/top]\n"
+        "a = ${self.b}\n"
+        "b = ${self.a}\n"
+        "c = ${self.undefined}\n"
+        "d = 1\n");
+
+    const auto fails = [&](const string& key) {
+      try {
+        conf->get<string>("bar/top", key);
+        return string{};
+      } catch (const value_error& err) {
+        return string{err.what()};
+      }
+    };
+
+    expect(fails("a").find("Reference cycle detected") != string::npos);
+    expect(fails("b").find("Reference cycle detected") != string::npos);
+    expect(fails("c").find("Unexisting reference") != string::npos);
+    expect(fails("d").empty());
+  };
+
+  "env_references"_test = [&] {
+    setenv("POLYBAR_TEST_SET", "value", 1);
+    unsetenv("POLYBAR_TEST_UNSET");
+
+    auto conf = load(
+        "[bar/top]\n"
+        "set = ${env:POLYBAR_TEST_SET:fallback}\n"
+        "unset = ${env:POLYBAR_TEST_UNSET:fallback}\n"
+        "bare = ${env:POLYBAR_TEST_UNSET}\n"
+        "indirect = ${self.unset}\n");
+
+    expect(conf->get<string>("bar/top", "set") == "value");
+    expect(conf->get<string>("bar/top", "unset") == "fallback");
+    expect(conf->get<string>("bar/top", "bare") == "${env:POLYBAR_TEST_UNSET}");
+    expect(conf->get<string>("bar/top", "indirect") == "fallback");
+  };
+
+  "changed_keys"_test = [&] {
+    auto conf = load(
+        "[bar/top]\n"
+        "width = 100\n"
+        "height = ${module/foo.size}\n"
+        "removed = 1\n"
+        "[module/foo]\n"
+        "size = 20\n"
+        "[module/bar]\n"
+        "label = bar\n");
+
+    write(
+        "[bar/top]\n"
+        "width = 100\n"
+        "height = ${module/foo.size}\n"
+        "added = 1\n"
+        "[module/foo]\n"
+        "size = 30\n"
+        "[module/bar]\n"
+        "label = bar\n");
+    conf->reload();
+
+    auto keys = conf->changed_keys("bar/top");
+    std::sort(keys.begin(), keys.end());
+    expect(keys == vector<string>{"added", "height", "removed"});
+    expect(conf->changed_keys("module/foo") == vector<string>{"size"});
+    expect(!conf->changed("module/bar"));
+    expect(conf->get<int>("bar/top", "height") == 30);
+  };
+
+  std::remove(path.c_str());
+}
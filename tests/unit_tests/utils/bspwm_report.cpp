@@ -0,0 +1,79 @@
+#include "utils/bspwm_report.cpp"
+
+int main() {
+  using namespace polybar;
+
+  const string report{BSPWM_STATUS_PREFIX "MeDP-1:Fone:otwo:uthree:LT:TT:G"};
+  const string other{BSPWM_STATUS_PREFIX "MeDP-1:fone:Otwo:fthree:LM:TF:GS"};
+
+  "feed_complete"_test = [&] {
+    bspwm_util::report_reader reader;
+    auto data = report + "\n";
+    expect(reader.feed(data.c_str(), data.size()));
+    expect(reader.report() == report);
+  };
+
+  "feed_split"_test = [&] {
+    bspwm_util::report_reader reader;
+    auto data = report + "\n";
+    auto half = data.size() / 2;
+    expect(!reader.feed(data.c_str(), half));
+    expect(reader.report().empty());
+    expect(reader.feed(data.c_str() + half, data.size() - half));
+    expect(reader.report() == report);
+  };
+
+  "feed_burst"_test = [&] {
+    bspwm_util::report_reader reader;
+    auto data = report + "\n" + other + "\n" + report.substr(0, 5);
+    expect(reader.feed(data.c_str(), data.size()));
+    expect(reader.report() == other);
+
+    // The trailing partial report is completed by the next read
+    auto rest = report.substr(5) + "\n";
+    expect(reader.feed(rest.c_str(), rest.size()));
+    expect(reader.report() == report);
+  };
+
+  "feed_empty_line"_test = [&] {
+    bspwm_util::report_reader reader;
+    expect(!reader.feed("\n", 1));
+  };
+
+  "parse"_test = [&] {
+    vector<bspwm_util::monitor_state> monitors;
+    expect(bspwm_util::parse_report(report + ":mHDMI-1:Ufour", monitors));
+    expect(monitors.size() == 2);
+    expect(monitors[0].name == "eDP-1");
+    expect(monitors[0].focused);
+    expect(monitors[0].desktops.size() == 3);
+    expect(monitors[0].desktops[0].flag == 'F');
+    expect(monitors[0].desktops[0].name == "one");
+    expect(monitors[0].desktops[2].flag == 'u');
+    expect(monitors[0].desktops[2].name == "three");
+    expect(monitors[0].layout == 'T');
+    expect(monitors[0].state == 'T');
+    expect(monitors[0].flags.empty());
+    expect(monitors[1].name == "HDMI-1");
+    expect(!monitors[1].focused);
+    expect(monitors[1].desktops.size() == 1);
+    expect(monitors[1].desktops[0].flag == 'U');
+  };
+
+  "parse_compare"_test = [&] {
+    vector<bspwm_util::monitor_state> a, b;
+    expect(bspwm_util::parse_report(report, a));
+    expect(bspwm_util::parse_report(report, b));
+    expect(a == b);
+    expect(bspwm_util::parse_report(other, b));
+    expect(!(a == b));
+    expect(b[0].flags == "S");
+  };
+
+  "parse_malformed"_test = [] {
+    vector<bspwm_util::monitor_state> monitors;
+    expect(!bspwm_util::parse_report("", monitors));
+    expect(!bspwm_util::parse_report("garbage", monitors));
+    expect(!bspwm_util::parse_report(BSPWM_STATUS_PREFIX "Fone:otwo", monitors));
+  };
+}
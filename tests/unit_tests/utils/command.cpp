@@ -0,0 +1,90 @@
+#include "components/logger.cpp"
+#include "utils/command.cpp"
+#include "utils/io.cpp"
+#include "utils/process.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+  using namespace std::chrono;
+
+  const logger& log = configure_logger().create<const logger&>();
+
+  // Run command in the pool and return the error message, if any
+  auto run = [](command_util::shell_pool& pool, const string& cmd, milliseconds timeout, string& output,
+                 command_util::shell_handle* handle = nullptr) {
+    try {
+      pool.run(cmd, timeout, [&](string line) { output = line; }, handle);
+      return string{};
+    } catch (const command_util::command_error& err) {
+      return string{err.what()};
+    }
+  };
+
+  "command_wait_timeout"_test = [&] {
+    // Closes its output right away but keeps running
+    auto cmd = command_util::make_command("exec >/dev/null 2>&1; sleep 10");
+    cmd->exec(false);
+    expect(cmd->tail([](string) {}, milliseconds{5000}));
+    expect(!cmd->wait(milliseconds{100}));
+    cmd->terminate();
+    expect(!cmd->is_running());
+
+    cmd = command_util::make_command("true");
+    cmd->exec(false);
+    expect(cmd->wait(milliseconds{5000}));
+  };
+
+  "shell_pool_run"_test = [&] {
+    command_util::shell_pool pool(log, 1);
+    string output;
+    expect(run(pool, "echo foo; echo bar", milliseconds{0}, output).empty());
+    expect(output == "bar");
+    expect(pool.run("exit 3", milliseconds{0}, [](string) {}) == 3);
+  };
+
+  "shell_pool_syntax_error"_test = [&] {
+    command_util::shell_pool pool(log, 1);
+    string output;
+    expect(pool.run("echo 'unbalanced", milliseconds{5000}, [](string) {}) != 0);
+    expect(run(pool, "echo 'quoted'", milliseconds{5000}, output).empty());
+    expect(output == "quoted");
+  };
+
+  "shell_pool_exited"_test = [&] {
+    command_util::shell_pool pool(log, 1);
+    string output;
+    expect(run(pool, "kill -9 $$", milliseconds{5000}, output) == "Shell exited unexpectedly");
+    expect(run(pool, "echo recovered", milliseconds{5000}, output).empty());
+    expect(output == "recovered");
+  };
+
+  "shell_pool_timeout"_test = [&] {
+    command_util::shell_pool pool(log, 1);
+    string output;
+    expect(run(pool, "sleep 10", milliseconds{100}, output) == "Command timed out");
+    expect(run(pool, "echo recovered", milliseconds{5000}, output).empty());
+    expect(output == "recovered");
+  };
+
+  "shell_pool_interrupt"_test = [&] {
+    command_util::shell_pool pool(log, 1);
+    command_util::shell_handle handle;
+    string output;
+
+    std::thread interrupter([&] {
+      this_thread::sleep_for(milliseconds{100});
+      pool.interrupt(handle);
+    });
+
+    auto start = steady_clock::now();
+    expect(run(pool, "sleep 10", milliseconds{0}, output, &handle) == "Command interrupted");
+    expect(steady_clock::now() - start < seconds{5});
+    interrupter.join();
+
+    // Interrupted handles stay interrupted, other callers can still use the pool
+    expect(run(pool, "echo foo", milliseconds{0}, output, &handle) == "Command interrupted");
+    expect(run(pool, "echo recovered", milliseconds{5000}, output).empty());
+    expect(output == "recovered");
+  };
+}
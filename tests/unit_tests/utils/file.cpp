@@ -0,0 +1,64 @@
+#include <unistd.h>
+#include <fstream>
+
+#include "utils/file.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "pread_reader"_test = [] {
+    char path[] = "/tmp/polybar_test_XXXXXX";
+    close(mkstemp(path));
+
+    std::ofstream(path) << "cpu 1 2 3\ncpu0 4 5 6\n";
+
+    file_util::pread_reader reader{path, 4};
+    size_t length{0};
+    expect(string{reader.read(&length)} == "cpu 1 2 3\ncpu0 4 5 6\n");
+    expect(length == 21);
+
+    std::ofstream(path) << "cpu 7 8 9\n";
+    expect(string{reader.read(&length)} == "cpu 7 8 9\n");
+    expect(length == 10);
+
+    unlink(path);
+  };
+
+  "field_reader"_test = [] {
+    char path[] = "/tmp/polybar_test_XXXXXX";
+    close(mkstemp(path));
+
+    std::ofstream(path) << "MemTotal:       16318812 kB\nMemFree:         1000 kB\nCached: 42 kB\n";
+
+    file_util::field_reader reader{path, {"MemFree", "Cached", "SwapTotal", "Mem"}};
+    expect(reader.read());
+    expect(reader.get(0) == 1000);
+    expect(reader.get(1) == 42);
+    expect(!reader.has(2) && reader.get(2) == 0);
+    expect(!reader.has(3));
+
+    // same layout, values read from the cached offsets
+    std::ofstream(path) << "MemTotal:       16318812 kB\nMemFree:         2000 kB\nCached: 43 kB\n";
+    expect(reader.read());
+    expect(reader.get(0) == 2000);
+    expect(reader.get(1) == 43);
+
+    // changed layout, offsets get looked up again
+    std::ofstream(path) << "Cached: 7 kB\nSwapTotal: 8 kB\nMemFree: 9 kB\n";
+    expect(reader.read());
+    expect(reader.get(0) == 9);
+    expect(reader.get(1) == 7);
+    expect(reader.has(2) && reader.get(2) == 8);
+
+    unlink(path);
+  };
+
+  "pread_reader_missing"_test = [] {
+    try {
+      file_util::pread_reader reader{"/nonexistent/file"};
+      expect(false);
+    } catch (const system_error& err) {
+      expect(true);
+    }
+  };
+}
@@ -0,0 +1,69 @@
+#include <unistd.h>
+
+#include "utils/io.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "readline"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+    string data{"foo\nbar\n\nbaz"};
+    expect(::write(fds[1], data.c_str(), data.size()) == static_cast<ssize_t>(data.size()));
+    close(fds[1]);
+
+    io_util::line_reader reader{fds[0]};
+    string line;
+    expect(reader.readline(line) && line == "foo");
+    expect(reader.buffered());
+    expect(reader.readline(line) && line == "bar");
+    expect(reader.readline(line) && line.empty());
+    expect(reader.readline(line) && line == "baz");
+    expect(!reader.readline(line));
+    expect(!reader.buffered());
+    close(fds[0]);
+  };
+
+  "timeout"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+    expect(::write(fds[1], "foo", 3) == 3);
+
+    io_util::line_reader reader{fds[0]};
+    string line;
+    expect(!reader.readline(line, 10));
+    expect(reader.timed_out());
+    expect(::write(fds[1], "bar\n", 4) == 4);
+    expect(reader.readline(line, 10) && line == "foobar");
+    expect(!reader.timed_out());
+    close(fds[1]);
+    expect(!reader.readline(line, 10));
+    expect(!reader.timed_out());
+    close(fds[0]);
+  };
+
+  "chunks"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+    string data(BUFSIZ + 10, 'x');
+    data += "\nend\n";
+
+    if (fork() == 0) {
+      close(fds[0]);
+      for (size_t i = 0; i < data.size(); i += 100) {
+        auto n = ::write(fds[1], data.c_str() + i, std::min<size_t>(100, data.size() - i));
+        (void)n;
+      }
+      _exit(0);
+    }
+    close(fds[1]);
+
+    io_util::line_reader reader{fds[0]};
+    string line;
+    expect(reader.readline(line) && line == string(BUFSIZ + 10, 'x'));
+    expect(reader.readline(line) && line == "end");
+    expect(!reader.readline(line));
+    close(fds[0]);
+  };
+}
@@ -46,4 +46,21 @@ int main() {
     expect(math_util::percentage_to_value(50, 200, 300) == 250);
     expect(math_util::percentage_to_value(50, 1, 5) == 3);
   };
+
+  "moving_average"_test = [] {
+    math_util::moving_average<int> avg{3};
+    expect(avg.get() == 0.0);
+    avg.push(3);
+    expect(avg.get() == 3.0);
+    avg.push(6);
+    avg.push(9);
+    expect(avg.get() == 6.0);
+    avg.push(12);
+    expect(avg.count() == 3);
+    expect(avg.get() == 9.0);
+    avg.clear();
+    expect(avg.count() == 0);
+    avg.push(1);
+    expect(avg.get() == 1.0);
+  };
 }
@@ -0,0 +1,35 @@
+#include <unistd.h>
+#include <fstream>
+
+#include "utils/file.cpp"
+#include "utils/mtab.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "mountinfo"_test = [] {
+    char path[] = "/tmp/polybar_test_XXXXXX";
+    close(mkstemp(path));
+
+    std::ofstream(path) << "22 1 8:2 / / rw,relatime shared:1 - ext4 /dev/sda2 rw\n"
+                        << "40 22 8:3 / /mnt/my\\040disk rw - vfat /dev/sdb1 rw\n"
+                        << "41 22 0:40 / /tmp rw,nosuid shared:5 master:2 - tmpfs tmpfs rw\n"
+                        << "42 41 0:41 / /tmp rw - overlay overlay rw\n";
+
+    mtab_util::mountinfo mtab{path};
+    mtab_util::mount_entry entry;
+
+    expect(mtab.find("/", entry));
+    expect(entry.type == "ext4" && entry.fsname == "/dev/sda2");
+
+    expect(mtab.find("/mnt/my disk", entry));
+    expect(entry.mountpoint == "/mnt/my disk" && entry.type == "vfat");
+
+    expect(mtab.find("/tmp", entry));
+    expect(entry.type == "overlay");
+
+    expect(!mtab.find("/home", entry));
+
+    unlink(path);
+  };
+}
@@ -0,0 +1,49 @@
+#include <sstream>
+
+#include "utils/stats.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "histogram_buckets"_test = [] {
+    stats_util::histogram hist;
+    hist.record(0);
+    hist.record(1);
+    hist.record(2);
+    hist.record(3);
+    hist.record(4);
+    hist.record(1000);
+    hist.record(uint64_t{1} << 40);
+
+    expect(hist.count() == 7);
+    expect(hist.total() == 1010 + (uint64_t{1} << 40));
+    expect(hist.bucket(0) == 1);
+    expect(hist.bucket(1) == 1);
+    expect(hist.bucket(2) == 2);
+    expect(hist.bucket(3) == 1);
+    expect(hist.bucket(10) == 1);
+    expect(hist.bucket(stats_util::histogram::BUCKETS - 1) == 1);
+  };
+
+  "histogram_measure"_test = [] {
+    stats_util::histogram hist;
+    expect(hist.measure([] { return 42; }) == 42);
+    expect(hist.count() == 1);
+  };
+
+  "histogram_json"_test = [] {
+    stats_util::histogram hist;
+    hist.record(3);
+    std::stringstream out;
+    hist.write_json(out);
+    expect(out.str() == "{\"count\":1,\"total_us\":3,\"buckets\":[0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]}");
+  };
+
+  "write_json_escape"_test = [] {
+    stats_util::module_counters counters;
+    std::stringstream out;
+    stats_util::write_json(out, {{"module/a\"b\\c", &counters}});
+    expect(out.str().find("\"modules\":{\"module/a\\\"b\\\\c\":{\"updates\":0") != string::npos);
+  };
+}
@@ -42,6 +42,12 @@ int main() {
     expect(string_util::strip_trailing_newline("test\n\n") == "test\n");
   };
 
+  "escape_json"_test = [] {
+    expect(string_util::escape_json("module/foo") == "module/foo");
+    expect(string_util::escape_json("a\"b\\c") == "a\\\"b\\\\c");
+    expect(string_util::escape_json("a\nb\tc") == "abc");
+  };
+
   "trim"_test = [] {
     expect(string_util::ltrim("xxtestxx", 'x') == "testxx");
     expect(string_util::rtrim("xxtestxx", 'x') == "xxtest");
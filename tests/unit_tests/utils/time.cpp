@@ -0,0 +1,33 @@
+#include <cstdlib>
+
+#include "utils/time.cpp"
+
+int main() {
+  using namespace polybar;
+
+  setenv("TZ", "UTC", 1);
+  tzset();
+
+  "format"_test = [] {
+    time_util::formatter formatter{"%Y-%m-%d %H:%M:%S"};
+    expect(formatter.format(0) == "1970-01-01 00:00:00");
+    expect(formatter.format(59) == "1970-01-01 00:00:59");
+    expect(formatter.format(60) == "1970-01-01 00:01:00");
+    expect(formatter.format(3599) == "1970-01-01 00:59:59");
+    expect(formatter.format(30) == "1970-01-01 00:00:30");
+  };
+
+  "literals"_test = [] {
+    time_util::formatter formatter{"100%% at %-H:%M%"};
+    expect(formatter.format(3600 * 9 + 60 * 5) == "100% at 9:05%");
+    expect(formatter.format(0) == "100% at 0:00%");
+  };
+
+  "seconds"_test = [] {
+    expect(time_util::formatter{"%H:%M:%S"}.seconds());
+    expect(time_util::formatter{"%T"}.seconds());
+    expect(time_util::formatter{"%OS"}.seconds());
+    expect(!time_util::formatter{"%H:%M"}.seconds());
+    expect(!time_util::formatter{"%a %d %b %%S"}.seconds());
+  };
+}
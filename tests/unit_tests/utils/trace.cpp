@@ -0,0 +1,53 @@
+#include <sstream>
+#include <thread>
+
+#include "utils/string.cpp"
+#include "utils/trace.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "disabled"_test = [] {
+    trace_util::enable(false);
+    { trace_util::span span{"test", "ignored"}; }
+    std::stringstream out;
+    expect(trace_util::dump(out) == 0);
+  };
+
+  "dump"_test = [] {
+    trace_util::enable(true);
+    { trace_util::span span{"test", "update", string{"module/foo"}}; }
+    { trace_util::span span{"test", "quoted\"name"}; }
+    trace_util::enable(false);
+
+    std::stringstream out;
+    expect(trace_util::dump(out) == 2);
+    expect(out.str().find("\"name\":\"update module/foo\",\"cat\":\"test\",\"ph\":\"X\"") != string::npos);
+    expect(out.str().find("\"name\":\"quoted\\\"name\"") != string::npos);
+  };
+
+  "overwrite"_test = [] {
+    trace_util::enable(true);
+    for (size_t i = 0; i < trace_util::BUFFER_SIZE + 10; i++) {
+      trace_util::span span{"test", "span"};
+    }
+    trace_util::enable(false);
+
+    std::stringstream out;
+    expect(trace_util::dump(out) == trace_util::BUFFER_SIZE);
+  };
+
+  "retired"_test = [] {
+    trace_util::enable(true);
+    for (size_t i = 0; i < trace_util::MAX_RETIRED_BUFFERS + 4; i++) {
+      std::thread([] { trace_util::span span{"test", "thread"}; }).join();
+    }
+    trace_util::enable(false);
+
+    // Only the latest buffers of exited threads are kept
+    std::stringstream out;
+    expect(trace_util::dump(out) == trace_util::BUFFER_SIZE + trace_util::MAX_RETIRED_BUFFERS);
+    out.str("");
+    expect(trace_util::dump(out) == trace_util::BUFFER_SIZE);
+  };
+}
@@ -0,0 +1,29 @@
+#include "utils/io.cpp"
+#include "utils/string.cpp"
+#include "utils/uevent.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "parse"_test = [] {
+    const char data[] =
+        "change@/devices/LNXSYSTM:00/PNP0C0A:00/power_supply/BAT0\0ACTION=change\0"
+        "DEVPATH=/devices/LNXSYSTM:00/PNP0C0A:00/power_supply/BAT0\0SUBSYSTEM=power_supply\0"
+        "POWER_SUPPLY_NAME=BAT0\0POWER_SUPPLY_CAPACITY=87";
+
+    uevent_util::event evt;
+    expect(uevent_util::parse(data, sizeof(data) - 1, evt));
+    expect(evt.action == "change");
+    expect(evt.devpath == "/devices/LNXSYSTM:00/PNP0C0A:00/power_supply/BAT0");
+    expect(evt.get("SUBSYSTEM") == "power_supply");
+    expect(evt.get("POWER_SUPPLY_NAME") == "BAT0");
+    expect(evt.get("POWER_SUPPLY_CAPACITY") == "87");
+    expect(evt.get("POWER_SUPPLY_STATUS").empty());
+  };
+
+  "parse_invalid"_test = [] {
+    const char data[] = "libudev\0\xfe\xed\xca\xfe";
+    uevent_util::event evt;
+    expect(!uevent_util::parse(data, sizeof(data) - 1, evt));
+  };
+}